@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+
 #include "../glm/vec2.hpp"
 #include "../glm/vec3.hpp"
 #include "../glm/vec4.hpp"
@@ -35,7 +37,7 @@ inline Float32 dot(V2f a, V2f b) { return a.x*b.x + a.y*b.y; }
 
 inline Float32 length_squared(V2f v) { return dot(v, v); }
 
-inline V2f round(V2f a) { return V2f { round(a.x), round(a.y) }; }
+inline V2f round(V2f a) { return V2f { std::round(a.x), std::round(a.y) }; }
 
 
 inline V4f make_color(Float32 r, Float32 g, Float32 b, Float32 a = 255) {
@@ -1,33 +1,45 @@
 #include <cpp-gui/core/widget.hpp>
 
-Def* Def::with_key(Key* key) {
-    assert(this->key == nullptr);
+Def* Def::with_key(Key key) {
+    assert(this->key.is_none());
     // @widget-def-ignore-keys
-    assert(dynamic_cast<Widget_Def*>(this) == nullptr);
+    assert(fast_cast<Widget_Def>(this) == nullptr);
 
     this->key = key;
     return this;
 }
 
+Def* Def::with_memo(Uint64 memo) {
+    // @widget-def-ignore-keys
+    assert(fast_cast<Widget_Def>(this) == nullptr);
+
+    this->memo     = memo;
+    this->has_memo = true;
+    return this;
+}
+
 Widget* Def::get_widget(Gui* gui) {
     assert(this->used == false);
 
     auto widget = this->on_get_widget(gui);
 
     // @widget-def-ignore-keys
-    auto is_widget_def = dynamic_cast<Widget_Def*>(this) != nullptr;
+    auto is_widget_def = fast_cast<Widget_Def>(this) != nullptr;
     if(is_widget_def == false) {
-        std::swap(widget->key, this->key);
+        widget->key = this->key;
+        widget->set_memo(this);
     }
 
     this->used = true;
     return widget;
 }
 
-Def::~Def() {
-    if(this->key != nullptr) {
-        delete this->key;
-        this->key = nullptr;
+Def::~Def() {}
+
+
+void delete_def(Def* def) {
+    if(def != nullptr && def->in_arena == false) {
+        delete def;
     }
 }
 
@@ -0,0 +1,65 @@
+#include <cstddef>
+
+#include <cpp-gui/core/def_arena.hpp>
+
+
+void* Def_Arena::allocate(Uint size, Uint align) {
+    // Blocks come from operator new.
+    assert(align <= alignof(std::max_align_t));
+
+    if(this->blocks.empty() == false) {
+        auto& block  = this->blocks.back();
+        auto  offset = aligned_pointer(this->cursor, align);
+        if(offset + size <= block.size) {
+            this->cursor = offset + size;
+            return block.memory + offset;
+        }
+    }
+
+    auto block_size = this->min_block_size;
+    if(this->blocks.empty() == false) {
+        block_size = max(block_size, 2*this->blocks.back().size);
+    }
+    block_size = max(block_size, size);
+
+    auto block = Block { (Uint8*)::operator new(block_size), block_size };
+    this->blocks.push_back(block);
+
+    this->cursor = size;
+    return block.memory;
+}
+
+
+void Def_Arena::reset() {
+    auto& destructors = this->destructors;
+    for(auto it = destructors.rbegin(); it != destructors.rend(); ++it) {
+        it->destroy(it->object);
+    }
+    destructors.clear();
+
+    // Replace multiple blocks by one that fits them all, so the next tree of
+    // the same size only needs one block.
+    if(this->blocks.size() > 1) {
+        auto total_size = Uint(0);
+        for(auto block : this->blocks) {
+            total_size += block.size;
+            ::operator delete(block.memory);
+        }
+        this->blocks.clear();
+
+        auto block = Block { (Uint8*)::operator new(total_size), total_size };
+        this->blocks.push_back(block);
+    }
+
+    this->cursor = 0;
+}
+
+void Def_Arena::destroy() {
+    this->reset();
+
+    for(auto block : this->blocks) {
+        ::operator delete(block.memory);
+    }
+    this->blocks.clear();
+}
+
@@ -0,0 +1,63 @@
+#include <cpp-gui/core/display_list.hpp>
+
+
+void Display_List::fill_rounded_rect(V2f min, V2f max, Float32 radius, V4f color) {
+    auto payload = this->push<Paint_Rounded_Rect>(Paint_Command_Type::fill_rounded_rect);
+    *payload = { min, max, radius, color };
+}
+
+void Display_List::stroke_rounded_rect(V2f min, V2f max, Float32 radius, V4f color) {
+    auto payload = this->push<Paint_Rounded_Rect>(Paint_Command_Type::stroke_rounded_rect);
+    *payload = { min, max, radius, color };
+}
+
+void Display_List::solid_rounded_rect(V2f min, V2f max, Float32 radius, V4f fill_color, V4f stroke_color) {
+    auto payload = this->push<Paint_Solid_Rounded_Rect>(Paint_Command_Type::solid_rounded_rect);
+    *payload = { min, max, radius, fill_color, stroke_color };
+}
+
+void Display_List::blurred_rounded_rect(V2f min, V2f max, Float32 corner_radius, Float32 blur_radius, V4f color) {
+    auto payload = this->push<Paint_Blurred_Rounded_Rect>(Paint_Command_Type::blurred_rounded_rect);
+    *payload = { min, max, corner_radius, blur_radius, color };
+}
+
+void Display_List::glyph_run(const Text_Layout* layout, V2f position, V4f color) {
+    auto payload = this->push<Paint_Glyph_Run>(Paint_Command_Type::glyph_run);
+    *payload = { layout, position, color };
+}
+
+
+void Display_List::push_transform(Paint_Transform transform) {
+    auto payload = this->push<Paint_Transform>(Paint_Command_Type::push_transform);
+    *payload = transform;
+}
+
+void Display_List::pop_transform() {
+    this->push_empty(Paint_Command_Type::pop_transform);
+}
+
+
+void Display_List::push_clip(V2f min, V2f max) {
+    auto payload = this->push<Paint_Clip>(Paint_Command_Type::push_clip);
+    *payload = { min, max };
+}
+
+void Display_List::pop_clip() {
+    this->push_empty(Paint_Command_Type::pop_clip);
+}
+
+
+void Display_List::child(Widget* widget) {
+    auto payload = this->push<Paint_Child>(Paint_Command_Type::child);
+    *payload = { widget };
+}
+
+
+void Display_List::push_empty(Paint_Command_Type type) {
+    auto offset = this->buffer.size();
+    this->buffer.resize(offset + sizeof(Paint_Command_Header));
+
+    auto header = (Paint_Command_Header*)&this->buffer[offset];
+    header->type = type;
+    header->size = (Uint32)sizeof(Paint_Command_Header);
+}
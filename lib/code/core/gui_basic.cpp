@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
 #include <cpp-gui/core/gui.hpp>
+#include <cpp-gui/core/render_backend.hpp>
 
 
 void Gui::request_frame() {
@@ -20,7 +25,127 @@ void Gui::create(Def* root_def, Void_Callback request_frame) {
 
 
 void Gui::destroy() {
-    safe_delete(&this->root_widget);
+    if(this->root_widget != nullptr) {
+        this->bury_widget(this->root_widget);
+        this->root_widget = nullptr;
+    }
+    this->free_graveyard(std::numeric_limits<Float64>::infinity());
+
+    this->def_arena.destroy();
+
+    this->destroy_stack_segments();
+
+    for(auto scratch : this->reconcile_scratch) {
+        delete scratch;
+    }
+    this->reconcile_scratch.clear();
+
+    for(auto pool : this->widget_pools) {
+        if(pool != nullptr) {
+            pool->destroy();
+            delete pool;
+        }
+    }
+    this->widget_pools.clear();
+}
+
+
+void Gui::destroy_widget(Widget* widget) {
+    auto pool = widget->pool;
+    if(pool == nullptr) {
+        delete widget;
+        return;
+    }
+
+    // The widget pointer points into the object (virtual bases).
+    auto memory = dynamic_cast<void*>(widget);
+    widget->~Widget();
+    pool->free(memory);
+}
+
+
+// Returns whether `widget` is `root` or one of its descendants.
+static Bool is_in_subtree(Widget* widget, Widget* root) {
+    for(auto at = widget; at != nullptr; at = at->parent) {
+        if(at == root) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Gui::bury_widget(Widget* widget) {
+    assert(widget->owner == nullptr && widget->parent == nullptr);
+
+    if(is_in_subtree(this->keyboard_focus_widget, widget)) {
+        this->set_keyboard_focus(nullptr);
+    }
+
+    if(is_in_subtree(this->mouse.focus_widget, widget)) {
+        this->set_mouse_focus(nullptr);
+    }
+
+    // No leave events: The widgets are gone.
+    auto& hot_list = this->mouse.hot_list;
+    hot_list.erase(
+        std::remove_if(hot_list.begin(), hot_list.end(), [&](Widget* hot) {
+            return is_in_subtree(hot, widget);
+        }),
+        hot_list.end()
+    );
+
+    // note: The layout queue and the damaged widgets aren't scanned (that
+    // made dropping n widgets O(n^2)). Each widget leaves them when it is
+    // destroyed. Until then, queued widgets are detached (flush_layout_queue
+    // skips them) and damaged ones at most add damage.
+    this->undamage_widget(widget);
+
+    // Where the subtree was painted.
+    if(widget->was_replayed) {
+        this->add_damage(widget->replay_bounds);
+    }
+
+    this->add_to_graveyard(widget);
+}
+
+void Gui::add_to_graveyard(Widget* widget) {
+    widget->is_buried = true;
+    this->graveyard.push_back(widget);
+
+    // Children are buried when their parent is destroyed. The outermost
+    // call frees them, so this doesn't recurse.
+    if(this->synchronous_teardown && this->freeing_graveyard == false) {
+        this->free_graveyard(std::numeric_limits<Float64>::infinity());
+    }
+}
+
+Bool Gui::free_graveyard(Float64 budget_seconds) {
+    using Clock = std::chrono::steady_clock;
+
+    auto start = Clock::now();
+    auto& graveyard = this->graveyard;
+
+    auto was_freeing = this->freeing_graveyard;
+    this->freeing_graveyard = true;
+    defer { this->freeing_graveyard = was_freeing; };
+
+    while(graveyard.empty() == false) {
+        // Don't read the clock for every widget.
+        for(Uint i = 0; i < 64 && graveyard.empty() == false; i += 1) {
+            auto widget = graveyard.back();
+            graveyard.pop_back();
+
+            // May bury children.
+            this->destroy_widget(widget);
+        }
+
+        auto elapsed = std::chrono::duration<Float64>(Clock::now() - start).count();
+        if(elapsed >= budget_seconds) {
+            break;
+        }
+    }
+
+    return graveyard.empty();
 }
 
 
@@ -39,12 +164,134 @@ void Gui::set_root(Def* def) {
     root = temp_parent.reconcile(root, def, Widget::New_Child_Action::none);
     root->owner  = nullptr;
     root->parent = nullptr;
+
+    this->def_arena.reset();
 }
 
 
-void Gui::render_frame(V2f size, ID2D1RenderTarget* target) {
+Key Gui::intern_key(const String& string) {
+    auto id = Uint64(this->interned_keys.size());
+    auto result = this->interned_keys.insert({ string, id });
+    return Key::make(Key_Type::string, result.first->second);
+}
+
+
+Gui::Reconcile_Scratch* Gui::push_reconcile_scratch() {
+    auto depth = this->reconcile_depth;
+    if(depth == this->reconcile_scratch.size()) {
+        this->reconcile_scratch.push_back(new Reconcile_Scratch());
+    }
+
+    this->reconcile_depth += 1;
+    return this->reconcile_scratch[depth];
+}
+
+void Gui::pop_reconcile_scratch() {
+    assert(this->reconcile_depth > 0);
+    this->reconcile_depth -= 1;
+}
+
+
+void Gui::queue_layout(Widget* boundary) {
+    if(boundary->in_layout_queue == false) {
+        boundary->in_layout_queue    = true;
+        boundary->layout_queue_index = this->layout_queue.size();
+        this->layout_queue.push_back(boundary);
+    }
+}
+
+void Gui::unqueue_layout(Widget* boundary) {
+    if(boundary->in_layout_queue) {
+        auto& queue = this->layout_queue;
+        assert(queue[boundary->layout_queue_index] == boundary);
+
+        auto last = queue.back();
+        queue[boundary->layout_queue_index] = last;
+        last->layout_queue_index = boundary->layout_queue_index;
+        queue.pop_back();
+
+        boundary->in_layout_queue = false;
+    }
+}
+
+
+// Returns whether the widget is part of the root's tree.
+static Bool get_depth_from_root(Gui* gui, Widget* widget, Uint* depth) {
+    auto current = widget;
+    *depth = 0;
+
+    while(current->parent != nullptr) {
+        current = current->parent;
+        *depth += 1;
+    }
+
+    return current == gui->root_widget;
+}
+
+void Gui::flush_layout_queue() {
+    struct Entry {
+        Uint    depth;
+        Widget* widget;
+    };
+
+    auto batch = List<Entry>();
+
+    while(this->layout_queue.empty() == false) {
+        batch.clear();
+
+        for(auto widget : this->layout_queue) {
+            widget->in_layout_queue = false;
+
+            // Detached widgets are laid out by their next parent.
+            auto depth = Uint(0);
+            if(get_depth_from_root(this, widget, &depth)) {
+                batch.push_back({ depth, widget });
+            }
+        }
+        this->layout_queue.clear();
+
+        // Detached widgets were dropped.
+        this->layout_epoch += 1;
+
+        // Shallow first: laying out a boundary may lay out deeper ones.
+        std::sort(batch.begin(), batch.end(), [](const Entry& a, const Entry& b) {
+            return a.depth < b.depth;
+        });
+
+        for(auto entry : batch) {
+            auto widget = entry.widget;
+            if(widget->needs_layout == false) {
+                continue;
+            }
+
+            auto old_size     = widget->size;
+            auto old_baseline = widget->baseline;
+
+            widget->layout(widget->layout_constraints);
+
+            // Widget didn't honor its constraints -> wasn't a boundary after all.
+            auto changed = widget->size != old_size || widget->baseline != old_baseline;
+            if(changed && widget->parent != nullptr) {
+                widget->parent->mark_for_layout();
+            }
+        }
+    }
+}
+
+
+const List<Paint_Bounds>& Gui::render_frame(V2f size, Render_Backend* backend) {
     this->root_widget->layout(Box_Constraints::tight(size));
-    this->root_widget->paint(target);
+    this->flush_layout_queue();
+
+    this->update_damage(backend->get_size());
+    this->paint_damage(backend);
+    backend->flush();
     this->has_requested_frame = false;
+
+    if(this->free_graveyard(this->teardown_budget) == false) {
+        this->request_frame();
+    }
+
+    return this->frame_damage;
 }
 
@@ -1,5 +1,3 @@
-#include <unordered_set>
-
 #include <cpp-gui/core/widget.hpp>
 #include <cpp-gui/core/gui.hpp>
 
@@ -63,51 +61,97 @@ inline void send_mouse_event_to_focus_or_hot_set(Gui* gui, F send_event) {
 }
 
 
-void Gui::update_mouse(Bool send_move_events) {
-    auto hit_test = this->root_widget->hit_test(this->mouse.position, &Widget::blocks_mouse);
+// Diffs the hot list against a new hit test and sends enter/leave events.
+static void update_hot_list(Gui* gui) {
+    auto& mouse = gui->mouse; // note: reference.
+
+    auto& hit_list = mouse.hit_list; // note: reference.
+    hit_list.clear();
 
-    auto new_list = List<Widget*>();
-    new_list.reserve(hit_test.size());
+    auto should_stop = [](Widget* widget) { return widget->blocks_mouse(); };
+    gui->root_widget->hit_test(mouse.position, should_stop, &hit_list);
 
-    // Reverse hit_test to be back-to-front and filter it.
-    for(auto it = hit_test.rbegin(); it != hit_test.rend(); ++it) {
+    auto& new_list = mouse.next_hot_list; // note: reference.
+    new_list.clear();
+
+    // Reverse hit_list to be back-to-front and filter it.
+    for(auto it = hit_list.rbegin(); it != hit_list.rend(); ++it) {
         auto widget = *it;
 
         auto should_receive_events = 
-               this->mouse.focus_widget == nullptr
-            || this->mouse.focus_widget == widget;
+               mouse.focus_widget == nullptr
+            || mouse.focus_widget == widget;
 
         if(widget->takes_mouse_input() && should_receive_events) {
             new_list.push_back(widget);
         }
     }
 
-    auto &old_list = this->mouse.hot_list; // note: reference.
+    auto &old_list = mouse.hot_list; // note: reference.
+
+    // Diff the lists by stamping the widgets.
+    //  - Old widgets get `in_old`.
+    //  - New widgets that have `in_old` are in both lists and get `in_both`.
+    //    The others are entering and get `in_new`.
+    //  - Old widgets that still have `in_old` are leaving.
+    auto in_old  = mouse.hot_stamp + 1;
+    auto in_both = mouse.hot_stamp + 2;
+    auto in_new  = mouse.hot_stamp + 3;
+    mouse.hot_stamp += 3;
+
+    for(auto widget : old_list) {
+        widget->hot_stamp = in_old;
+    }
 
-    auto old_set = std::unordered_set<Widget*>(old_list.begin(), old_list.end());
-    auto new_set = std::unordered_set<Widget*>(new_list.begin(), new_list.end());
+    for(auto widget : new_list) {
+        widget->hot_stamp = (widget->hot_stamp == in_old) ? in_both : in_new;
+    }
 
     // Generate leave messages.
     for(auto widget : old_list) {
-        if(contains(new_set, widget) == false) {
+        if(widget->hot_stamp == in_old) {
             widget->on_mouse_leave();
         }
     }
 
     // Generate enter messages.
     for(auto widget : new_list) {
-        if(contains(old_set, widget) == false) {
+        if(widget->hot_stamp == in_new) {
             widget->on_mouse_enter();
         }
     }
 
-    this->mouse.hot_list = new_list;
+    std::swap(mouse.hot_list, new_list);
+}
 
-    // Generate move messages.
-    if(send_move_events) {
-        send_mouse_event_to_focus_or_hot_set(this, [](Widget* widget) {
-            return widget->on_mouse_move();
-        });
+void Gui::update_mouse(Bool send_move_events) {
+    // Event handlers may call back into update_mouse (eg: by grabbing the
+    // mouse focus). The outer call is iterating the hot lists and owns the
+    // stamps, so nested calls are queued. The outer call updates again when
+    // it is done, until no more updates are queued.
+    if(this->mouse.updating) {
+        this->mouse.update_pending       = true;
+        this->mouse.pending_move_events |= send_move_events;
+        return;
+    }
+
+    this->mouse.updating = true;
+    defer { this->mouse.updating = false; };
+
+    this->mouse.update_pending      = true;
+    this->mouse.pending_move_events = send_move_events;
+
+    while(this->mouse.update_pending) {
+        this->mouse.update_pending = false;
+        update_hot_list(this);
+
+        // Generate move messages.
+        if(this->mouse.pending_move_events) {
+            this->mouse.pending_move_events = false;
+            send_mouse_event_to_focus_or_hot_set(this, [](Widget* widget) {
+                return widget->on_mouse_move();
+            });
+        }
     }
 }
 
@@ -153,9 +197,19 @@ void Gui::on_mouse_leave() {
     }
     this->mouse.entered = false;
 
+    // Updates queued by the handlers are dropped: The mouse is outside.
+    auto is_updating = this->mouse.updating;
+    this->mouse.updating = true;
+
     for(auto widget : this->mouse.hot_list) {
         widget->on_mouse_leave();
     }
     this->mouse.hot_list.clear();
+
+    this->mouse.updating = is_updating;
+    if(is_updating == false) {
+        this->mouse.update_pending      = false;
+        this->mouse.pending_move_events = false;
+    }
 }
 
@@ -0,0 +1,435 @@
+#include <limits>
+
+#include <cpp-gui/core/gui.hpp>
+#include <cpp-gui/core/render_backend.hpp>
+
+
+// Applies `inner`, then `outer`.
+static Paint_Transform combine(const Paint_Transform& inner, const Paint_Transform& outer) {
+    auto linear = [&](V2f v) { return v.x*outer.x_axis + v.y*outer.y_axis; };
+
+    return Paint_Transform {
+        linear(inner.x_axis),
+        linear(inner.y_axis),
+        linear(inner.offset) + outer.offset,
+    };
+}
+
+// Whether primitives drawn with `transform` can be drawn with `current`
+// instead, offset by get_offset. (Same linear part, invertible.)
+static Bool can_offset(const Paint_Transform& current, const Paint_Transform& transform) {
+    auto det = current.x_axis.x*current.y_axis.y - current.y_axis.x*current.x_axis.y;
+
+    return transform.x_axis == current.x_axis
+        && transform.y_axis == current.y_axis
+        && det != 0.0f;
+}
+
+static V2f get_offset(const Paint_Transform& current, const Paint_Transform& transform) {
+    auto det = current.x_axis.x*current.y_axis.y - current.y_axis.x*current.x_axis.y;
+
+    // Solve current.x_axis*v.x + current.y_axis*v.y = delta.
+    auto delta = transform.offset - current.offset;
+    return V2f {
+        ( current.y_axis.y*delta.x - current.y_axis.x*delta.y) / det,
+        (-current.x_axis.y*delta.x + current.x_axis.x*delta.y) / det,
+    };
+}
+
+
+// The widget's paint bounds, grown by how far its children paint past their
+// rects. (Assumes the children are inside the widget's rect.)
+static Paint_Bounds get_subtree_paint_bounds(Widget* widget) {
+    auto bounds = widget->get_paint_bounds();
+    auto margin = V2f(widget->child_paint_overflow);
+    return Paint_Bounds { bounds.min - margin, bounds.max + margin };
+}
+
+
+void Gui::replay(Widget* widget, Render_Backend* backend, Paint_Bounds visible) {
+    auto base_transform = backend->get_transform();
+
+    auto& stack = this->replay_stack;
+    stack.clear();
+
+    // Transforms to restore on pop_transform.
+    auto& transform_stack = this->replay_transform_stack;
+    transform_stack.clear();
+
+    // Visible areas to restore on pop_clip.
+    auto& clip_stack = this->replay_clip_stack;
+    clip_stack.clear();
+
+    // The target's transform is only set when the linear part changes.
+    // Otherwise, primitives are offset by the difference in translation.
+    // (Usually everything only translates.)
+    auto target_transform = base_transform;
+    auto target_changed   = false;
+
+    // Returns the offset to apply to primitives drawn with `transform`.
+    auto use_transform = [&](const Paint_Transform& transform) {
+        if(can_offset(target_transform, transform)) {
+            return get_offset(target_transform, transform);
+        }
+
+        // Back to the base's linear part -> set the base transform, so it
+        // doesn't have to be restored.
+        if(can_offset(base_transform, transform)) {
+            backend->set_transform(base_transform);
+            target_transform = base_transform;
+            target_changed   = true;
+            return get_offset(base_transform, transform);
+        }
+
+        backend->set_transform(transform);
+        target_transform = transform;
+        target_changed   = true;
+        return V2f { 0, 0 };
+    };
+
+    auto enter = [&](Widget* widget, const Paint_Transform& outer, const Paint_Bounds& visible) {
+        auto transform = combine(Paint_Transform::translation(widget->position), outer);
+
+        // With the children's overflow: Damage that only touches their
+        // shadows still reaches them.
+        auto bounds = get_subtree_paint_bounds(widget).transformed(transform);
+
+        widget->was_replayed           = true;
+        widget->replay_outer_transform = outer;
+        widget->replay_bounds          = bounds;
+
+        if(bounds.intersects(visible) == false) {
+            this->culled_widget_count += 1;
+            return;
+        }
+
+        this->replayed_widget_count += 1;
+        widget->update_display_list();
+
+        if(this->draw_widget_rects) {
+            auto offset = use_transform(transform);
+            auto rect   = Paint_Rounded_Rect {};
+            rect.min    = offset + V2f(0.5f);
+            rect.max    = offset + widget->size - V2f(0.5f);
+            rect.radius = 0.0f;
+            rect.color  = { 1.0f, 0.0f, 1.0f, 0.5f };
+            backend->stroke_rounded_rect(rect);
+        }
+
+        // Ordered containers narrow the children to test. (Clips pushed by
+        // the widget only narrow `visible` further.)
+        auto children = Range<Uint> { 0, std::numeric_limits<Uint>::max() };
+        if(transform.is_translation()) {
+            auto margin = V2f(widget->child_paint_overflow);
+            children = widget->get_children_to_replay(Paint_Bounds {
+                visible.min - transform.offset - margin,
+                visible.max - transform.offset + margin,
+            });
+        }
+
+        stack.push_back({
+            widget, 0,
+            transform, transform_stack.size(),
+            visible,   clip_stack.size(),
+            children,  0,
+        });
+    };
+
+    enter(widget, target_transform, visible);
+
+    while(stack.empty() == false) {
+        auto& frame  = stack.back();
+        auto& buffer = frame.widget->display_list.buffer;
+
+        // Done with this widget -> back to its parent.
+        if(frame.cursor >= buffer.size()) {
+            transform_stack.resize(frame.transform_stack_size);
+            clip_stack.resize(frame.clip_stack_size);
+            stack.pop_back();
+            continue;
+        }
+
+        auto header = (const Paint_Command_Header*)&buffer[frame.cursor];
+        frame.cursor += header->size;
+
+        switch(header->type) {
+            case Paint_Command_Type::fill_rounded_rect: {
+                auto rect   = *get_payload<Paint_Rounded_Rect>(header);
+                auto offset = use_transform(frame.transform);
+                rect.min = rect.min + offset;
+                rect.max = rect.max + offset;
+                backend->fill_rounded_rect(rect);
+            } break;
+
+            case Paint_Command_Type::stroke_rounded_rect: {
+                auto rect   = *get_payload<Paint_Rounded_Rect>(header);
+                auto offset = use_transform(frame.transform);
+                rect.min = rect.min + offset;
+                rect.max = rect.max + offset;
+                backend->stroke_rounded_rect(rect);
+            } break;
+
+            case Paint_Command_Type::solid_rounded_rect: {
+                auto rect   = *get_payload<Paint_Solid_Rounded_Rect>(header);
+                auto offset = use_transform(frame.transform);
+                rect.min = rect.min + offset;
+                rect.max = rect.max + offset;
+                backend->solid_rounded_rect(rect);
+            } break;
+
+            case Paint_Command_Type::blurred_rounded_rect: {
+                auto shadow = *get_payload<Paint_Blurred_Rounded_Rect>(header);
+                auto offset = use_transform(frame.transform);
+                shadow.min = shadow.min + offset;
+                shadow.max = shadow.max + offset;
+                backend->blurred_rounded_rect(shadow);
+            } break;
+
+            case Paint_Command_Type::glyph_run: {
+                auto run    = *get_payload<Paint_Glyph_Run>(header);
+                auto offset = use_transform(frame.transform);
+                run.position = run.position + offset;
+                backend->glyph_run(run);
+            } break;
+
+            case Paint_Command_Type::push_transform: {
+                auto transform = get_payload<Paint_Transform>(header);
+                transform_stack.push_back(frame.transform);
+                frame.transform = combine(*transform, frame.transform);
+            } break;
+
+            case Paint_Command_Type::pop_transform: {
+                if(transform_stack.size() > frame.transform_stack_size) {
+                    frame.transform = transform_stack.back();
+                    transform_stack.pop_back();
+                }
+            } break;
+
+            case Paint_Command_Type::push_clip: {
+                // The clip is transformed when it is pushed.
+                auto clip   = get_payload<Paint_Clip>(header);
+                auto offset = use_transform(frame.transform);
+                backend->push_clip(Paint_Bounds { clip->min + offset, clip->max + offset }, false);
+
+                auto bounds = Paint_Bounds { clip->min, clip->max }.transformed(frame.transform);
+                clip_stack.push_back(frame.visible);
+                frame.visible = frame.visible.intersect(bounds);
+            } break;
+
+            case Paint_Command_Type::pop_clip: {
+                backend->pop_clip();
+
+                if(clip_stack.size() > frame.clip_stack_size) {
+                    frame.visible = clip_stack.back();
+                    clip_stack.pop_back();
+                }
+            } break;
+
+            case Paint_Command_Type::child: {
+                auto index = frame.child_index;
+                frame.child_index += 1;
+
+                // Outside the parent's range: Culled without its bounds.
+                if(index < frame.children._begin || index >= frame.children._end) {
+                    this->culled_widget_count += 1;
+                    break;
+                }
+
+                // Note: invalidates frame.
+                enter(get_payload<Paint_Child>(header)->widget, frame.transform, frame.visible);
+            } break;
+        }
+    }
+
+    // Restore the base transform (unless the last change was back to it).
+    auto is_base =
+           target_transform.x_axis == base_transform.x_axis
+        && target_transform.y_axis == base_transform.y_axis
+        && target_transform.offset == base_transform.offset;
+
+    if(target_changed && is_base == false) {
+        backend->set_transform(base_transform);
+    }
+}
+
+
+
+static Float32 get_area(const Paint_Bounds& bounds) {
+    auto size = bounds.max - bounds.min;
+    return size.x*size.y;
+}
+
+static Paint_Bounds get_union(const Paint_Bounds& a, const Paint_Bounds& b) {
+    return Paint_Bounds { min(a.min, b.min), max(a.max, b.max) };
+}
+
+void Gui::add_damage(Paint_Bounds bounds) {
+    if(this->damaged_all || (bounds.min < bounds.max) == false) {
+        return;
+    }
+
+    auto& damage = this->damage;
+
+    // Merge with rects whose union isn't larger than the two rects. (Mostly
+    // overlapping ones.) The union may absorb more rects.
+    auto merged = true;
+    while(merged) {
+        merged = false;
+
+        for(Uint i = 0; i < damage.size(); i += 1) {
+            auto merged_bounds = get_union(damage[i], bounds);
+            if(get_area(merged_bounds) <= get_area(damage[i]) + get_area(bounds)) {
+                bounds = merged_bounds;
+                damage[i] = damage.back();
+                damage.pop_back();
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    damage.push_back(bounds);
+
+    // Too many rects -> merge the pair that adds the least area.
+    if(damage.size() > this->max_damage_rects) {
+        auto best_i    = Uint(0);
+        auto best_j    = Uint(1);
+        auto best_cost = std::numeric_limits<Float32>::infinity();
+
+        for(Uint i = 0; i < damage.size(); i += 1) {
+            for(Uint j = i + 1; j < damage.size(); j += 1) {
+                auto cost =
+                      get_area(get_union(damage[i], damage[j]))
+                    - get_area(damage[i]) - get_area(damage[j]);
+
+                if(cost < best_cost) {
+                    best_i    = i;
+                    best_j    = j;
+                    best_cost = cost;
+                }
+            }
+        }
+
+        damage[best_i] = get_union(damage[best_i], damage[best_j]);
+        damage[best_j] = damage.back();
+        damage.pop_back();
+    }
+}
+
+void Gui::damage_all() {
+    this->damaged_all = true;
+    this->damage.clear();
+}
+
+void Gui::damage_widget(Widget* widget) {
+    if(widget->is_damaged || widget->is_buried) {
+        return;
+    }
+
+    widget->is_damaged    = true;
+    widget->damaged_index = this->damaged_widgets.size();
+    this->damaged_widgets.push_back(widget);
+}
+
+void Gui::undamage_widget(Widget* widget) {
+    if(widget->is_damaged == false) {
+        return;
+    }
+
+    auto& damaged = this->damaged_widgets;
+    assert(damaged[widget->damaged_index] == widget);
+
+    auto last = damaged.back();
+    damaged[widget->damaged_index] = last;
+    last->damaged_index = widget->damaged_index;
+    damaged.pop_back();
+
+    widget->is_damaged = false;
+}
+
+void Gui::update_damage(V2f target_size) {
+    if(target_size != this->damage_target_size) {
+        this->damage_target_size = target_size;
+        this->damaged_all = true;
+        this->damage.clear();
+    }
+
+    // Every change to the paint bounds damages the widget, so the parent's
+    // overflow is an upper bound. First, so the damage below includes the
+    // overflow of new children.
+    for(auto widget : this->damaged_widgets) {
+        if(widget->parent != nullptr) {
+            auto bounds   = get_subtree_paint_bounds(widget);
+            auto overflow = max(
+                max(-bounds.min.x, -bounds.min.y),
+                max(bounds.max.x - widget->size.x, bounds.max.y - widget->size.y)
+            );
+
+            auto& parent_overflow = widget->parent->child_paint_overflow;
+            parent_overflow = max(parent_overflow, overflow);
+        }
+    }
+
+    // Old and new bounds, with the children's overflow: Children move with
+    // their parent's layout without being damaged. (Widgets that were never
+    // replayed are new. Their parent was laid out and is damaged.)
+    for(auto widget : this->damaged_widgets) {
+        widget->is_damaged = false;
+
+        if(widget->was_replayed) {
+            auto transform = combine(Paint_Transform::translation(widget->position), widget->replay_outer_transform);
+            this->add_damage(widget->replay_bounds);
+            this->add_damage(get_subtree_paint_bounds(widget).transformed(transform));
+        }
+    }
+    this->damaged_widgets.clear();
+
+    auto target_bounds = Paint_Bounds { V2f { 0, 0 }, target_size };
+
+    auto& frame_damage = this->frame_damage;
+    frame_damage.clear();
+
+    if(this->damaged_all) {
+        frame_damage.push_back(target_bounds);
+    }
+    else {
+        for(auto bounds : this->damage) {
+            // Whole pixels, so the aliased clips don't leave seams.
+            bounds = bounds.intersect(target_bounds);
+            bounds.min = V2f { floorf(bounds.min.x), floorf(bounds.min.y) };
+            bounds.max = V2f { ceilf(bounds.max.x),  ceilf(bounds.max.y)  };
+
+            if(bounds.min < bounds.max) {
+                frame_damage.push_back(bounds);
+            }
+        }
+    }
+
+    this->damage.clear();
+    this->damaged_all = false;
+}
+
+void Gui::paint_damage(Render_Backend* backend) {
+    // The clips are in the target's coordinates.
+    auto base_transform = backend->get_transform();
+    auto is_identity    = base_transform.is_translation() && base_transform.offset == V2f { 0, 0 };
+
+    this->replayed_widget_count = 0;
+    this->culled_widget_count   = 0;
+
+    for(auto bounds : this->frame_damage) {
+        if(is_identity == false) {
+            backend->set_transform(Paint_Transform::translation(V2f { 0, 0 }));
+        }
+
+        backend->push_clip(bounds, true);
+
+        if(is_identity == false) {
+            backend->set_transform(base_transform);
+        }
+
+        backend->clear(this->clear_color);
+        this->replay(this->root_widget, backend, bounds);
+        backend->pop_clip();
+    }
+}
@@ -0,0 +1,185 @@
+#include <cpp-gui/core/gui.hpp>
+#include <cpp-gui/platform.hpp>
+
+// Stack segments, per platform. See Gui::recurse.
+//  - Win32: Fibers. Switching to a fiber needs the calling thread to be a
+//    fiber too, and converting it changes state that belongs to the app. So
+//    segments are only used if the app converted the thread itself (eg:
+//    ConvertThreadToFiber in main).
+//  - glibc: ucontext. Doesn't change the thread's state.
+//  - Elsewhere, or if a segment can't be created: The recursion continues on
+//    the caller's stack.
+//  - Exceptions can't cross segments. Code that runs on segments (on_layout,
+//    on_try_match) must not throw.
+
+#if CPP_GUI_WIN32
+    #include <cpp-gui/win32.hpp>
+    #define STACK_SEGMENTS_WIN32 1
+#elif defined(__GLIBC__)
+    #include <ucontext.h>
+    #define STACK_SEGMENTS_UCONTEXT 1
+#endif
+
+
+// Reserved stack size of a segment. Committed as needed.
+static const Uint stack_segment_size = 1024*1024;
+
+
+#if defined(STACK_SEGMENTS_WIN32)
+
+struct Gui::Stack_Segment {
+    void* fiber;
+    void* caller;
+    const Function_Ref<void()>* function;
+};
+
+static void CALLBACK stack_segment_main(void* parameter) {
+    auto segment = (Gui::Stack_Segment*)parameter;
+
+    while(true) {
+        (*segment->function)();
+        SwitchToFiber(segment->caller);
+    }
+}
+
+static Bool can_use_stack_segments() {
+    return IsThreadAFiber() != FALSE;
+}
+
+static Gui::Stack_Segment* create_stack_segment() {
+    auto segment = new Gui::Stack_Segment {};
+    segment->fiber = CreateFiberEx(
+        64*1024, stack_segment_size, 0,
+        stack_segment_main, segment
+    );
+
+    if(segment->fiber == nullptr) {
+        delete segment;
+        return nullptr;
+    }
+    return segment;
+}
+
+static void run_on(Gui::Stack_Segment* segment) {
+    segment->caller = GetCurrentFiber();
+    SwitchToFiber(segment->fiber);
+}
+
+static void destroy_stack_segment(Gui::Stack_Segment* segment) {
+    DeleteFiber(segment->fiber);
+    delete segment;
+}
+
+#elif defined(STACK_SEGMENTS_UCONTEXT)
+
+struct Gui::Stack_Segment {
+    ucontext_t context;
+    ucontext_t caller;
+    Uint8*     stack;
+    const Function_Ref<void()>* function;
+};
+
+// makecontext only passes ints -> the pointer is split in two.
+static void stack_segment_main(Uint32 low, Uint32 high) {
+    auto segment = (Gui::Stack_Segment*)(Uint)((Uint64(high) << 32) | low);
+
+    while(true) {
+        (*segment->function)();
+        swapcontext(&segment->context, &segment->caller);
+    }
+}
+
+static Bool can_use_stack_segments() {
+    return true;
+}
+
+static Gui::Stack_Segment* create_stack_segment() {
+    auto segment = new Gui::Stack_Segment {};
+    if(getcontext(&segment->context) != 0) {
+        delete segment;
+        return nullptr;
+    }
+
+    // note: Large allocations are mapped, so pages are committed as needed.
+    segment->stack = new Uint8[stack_segment_size];
+    segment->context.uc_stack.ss_sp   = segment->stack;
+    segment->context.uc_stack.ss_size = stack_segment_size;
+    segment->context.uc_link          = nullptr;
+
+    auto address = Uint64(Uint(segment));
+    makecontext(
+        &segment->context, (void (*)())stack_segment_main, 2,
+        Uint32(address), Uint32(address >> 32)
+    );
+    return segment;
+}
+
+static void run_on(Gui::Stack_Segment* segment) {
+    swapcontext(&segment->caller, &segment->context);
+}
+
+static void destroy_stack_segment(Gui::Stack_Segment* segment) {
+    delete[] segment->stack;
+    delete segment;
+}
+
+#else
+
+struct Gui::Stack_Segment {
+    const Function_Ref<void()>* function;
+};
+
+static Bool can_use_stack_segments() {
+    return false;
+}
+
+static Gui::Stack_Segment* create_stack_segment() {
+    return nullptr;
+}
+
+static void run_on(Gui::Stack_Segment* segment) {
+    UNUSED(segment);
+}
+
+static void destroy_stack_segment(Gui::Stack_Segment* segment) {
+    delete segment;
+}
+
+#endif
+
+
+void Gui::run_on_stack_segment(Function_Ref<void()> function) {
+    if(can_use_stack_segments() == false) {
+        function();
+        return;
+    }
+
+    // Segments are used like a stack: Nested calls get the next one.
+    auto index = this->stack_segment_depth;
+    if(index == this->stack_segments.size()) {
+        auto segment = create_stack_segment();
+        if(segment == nullptr) {
+            function();
+            return;
+        }
+
+        this->stack_segments.push_back(segment);
+    }
+
+    auto segment = this->stack_segments[index];
+    segment->function = &function;
+
+    this->stack_segment_depth += 1;
+    run_on(segment);
+    this->stack_segment_depth -= 1;
+}
+
+
+void Gui::destroy_stack_segments() {
+    assert(this->stack_segment_depth == 0);
+
+    for(auto segment : this->stack_segments) {
+        destroy_stack_segment(segment);
+    }
+    this->stack_segments.clear();
+}
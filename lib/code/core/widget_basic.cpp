@@ -1,72 +1,160 @@
 #include <cpp-gui/core/widget.hpp>
 #include <cpp-gui/core/gui.hpp>
-#include <cpp-gui/d2d.hpp>
 
 
 
-static Bool hit_test_helper(Widget* widget, V2f point, std::function<Bool(Widget*)> should_stop, List<Widget*>* result) {
-    // Note: widget was hit.
+static void hit_test_iterative(
+    Widget* root, V2f point, Function_Ref<Bool(Widget*)> should_stop, List<Widget*>* result,
+    List<Gui::Hit_Test_Frame>& stack, List<Widget*>& children
+) {
+    // Equivalent to recursing into each hit child (front to back), then
+    // adding the widget unless something in front stopped the test.
+    //  - The hit children of the frames on the stack are kept in `children`.
 
-    // First, recurse for front-to-back order.
-    auto stopped = widget->visit_children_for_hit_testing([&](Widget* child) {
-        auto query = point - child->position;
-        return child->on_hit_test(query)
-            && hit_test_helper(child, query, should_stop, result);
-    }, point);
+    auto push_frame = [&](Widget* widget, V2f point) {
+        auto begin = children.size();
 
-    if(stopped) {
-        return true;
-    }
+        widget->visit_children_for_hit_testing([&](Widget* child) {
+            if(child->on_hit_test(point - child->position)) {
+                children.push_back(child);
+            }
+            return false;
+        }, point);
 
-    // Nothing in front blocked this widget -> add to hit list.
-    result->push_back(widget);
-    return should_stop(widget);
-}
+        stack.push_back({ widget, point, begin, children.size() });
+    };
+
+    // Note: root was hit.
+    push_frame(root, point);
+
+    while(stack.empty() == false) {
+        auto& frame = stack.back();
+
+        if(frame.next_child < frame.end_child) {
+            auto child = children[frame.next_child];
+            frame.next_child += 1;
 
-List<Widget*> Widget::hit_test(V2f point, std::function<Bool(Widget*)> should_stop) {
-    auto result = List<Widget*>();
+            // Note: invalidates frame.
+            push_frame(child, frame.point - child->position);
+            continue;
+        }
+
+        // Nothing in front blocked this widget -> add to hit list.
+        auto widget = frame.widget;
+        stack.pop_back();
+
+        // This frame's children follow its parent's.
+        children.resize(stack.empty() ? 0 : stack.back().end_child);
+
+        result->push_back(widget);
+        if(should_stop(widget)) {
+            return;
+        }
+    }
+}
 
-    if(this->on_hit_test(point)) {
-        hit_test_helper(this, point, should_stop, &result);
+void Widget::hit_test(V2f point, Function_Ref<Bool(Widget*)> should_stop, List<Widget*>* result) {
+    if(this->on_hit_test(point) == false) {
+        return;
     }
 
-    return result;
+    // Nested hit tests (from handlers) can't reuse the scratch buffers.
+    auto nested_stack    = List<Gui::Hit_Test_Frame>();
+    auto nested_children = List<Widget*>();
+
+    auto is_nested = gui->hit_testing;
+    gui->hit_testing = true;
+    defer { gui->hit_testing = is_nested; };
+
+    auto& stack    = is_nested ? nested_stack    : gui->hit_test_stack;    // note: reference.
+    auto& children = is_nested ? nested_children : gui->hit_test_children; // note: reference.
+    stack.clear();
+    children.clear();
+
+    hit_test_iterative(this, point, should_stop, result, stack, children);
 }
 
 
 
 void Widget::mark_for_layout() {
+    // Ancestors may depend on our layout -> mark them too.
+    //  Stop at the first widget that was already marked since the last
+    //  layout finished (see Gui::layout_epoch). Its ancestors have been
+    //  marked (or it was queued) when it was, and nothing has cleared them
+    //  since. Older marks may be stale (eg: its parent skipped it, or was
+    //  in on_layout and cleared its own mark afterwards).
+    //  Stop at relayout boundaries and queue them instead.
+    //  Widgets that were never laid out are laid out by their next parent.
+    auto epoch   = gui->layout_epoch;
+    auto current = this;
+    while(current->needs_layout == false || current->layout_mark_epoch != epoch) {
+        current->needs_layout      = true;
+        current->layout_mark_epoch = epoch;
+
+        if(current->has_layout == false) {
+            break;
+        }
+
+        if(current->parent == nullptr || current->is_relayout_boundary()) {
+            gui->queue_layout(current);
+            break;
+        }
+
+        current = current->parent;
+    }
+
     gui->request_frame();
 }
 
 void Widget::layout(Box_Constraints constraints) {
-    this->on_layout(constraints);
+    if(this->needs_layout == false && this->layout_constraints == constraints) {
+        return;
+    }
+
+    // Cleared first: If on_layout marks a child it has already laid out,
+    // the mark reaches us and stays set. (And queues a boundary above.)
+    this->needs_layout = false;
+
+    gui->recurse([&]() { this->on_layout(constraints); });
+
+    this->layout_constraints = constraints;
+    this->has_layout         = true;
+    this->layout_version    += 1;
+
+    gui->layout_epoch += 1;
+
+    // Size or child positions may have changed.
+    this->needs_paint = true;
+    gui->damage_widget(this);
+}
+
+Bool Widget::is_relayout_boundary() {
+    if(this->has_layout == false) {
+        return false;
+    }
+
+    auto is_tight = this->layout_constraints.min == this->layout_constraints.max;
+    return is_tight || this->sized_by_parent();
 }
 
 
 
 void Widget::mark_for_paint() {
+    this->needs_paint = true;
+    gui->damage_widget(this);
     gui->request_frame();
 }
 
-void Widget::paint(ID2D1RenderTarget* target) {
-    auto old_tfx = D2D_MATRIX_3X2_F {};
-    target->GetTransform(&old_tfx);
-    target->SetTransform(old_tfx * D2D1::Matrix3x2F::Translation(to_d2d_sizef(this->position)));
-
-    if(gui->draw_widget_rects) {
-        auto brush = (ID2D1SolidColorBrush*)nullptr;
-        auto hr = target->CreateSolidColorBrush({ 1.0f, 0.0f, 1.0f, 0.5f }, &brush);
+void Widget::paint(Display_List* list) {
+    list->child(this);
+}
 
-        if(SUCCEEDED(hr)) {
-            target->DrawRectangle({ 0.5f, 0.5f, this->size.x - 0.5f, this->size.y - 0.5f }, brush);
-            brush->Release();
-        }
+void Widget::update_display_list() {
+    if(this->needs_paint) {
+        this->display_list.clear();
+        this->on_paint(&this->display_list);
+        this->needs_paint = false;
     }
-
-    this->on_paint(target);
-
-    target->SetTransform(old_tfx);
 }
 
 
@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <limits>
+
 #include <cpp-gui/core/widget.hpp>
+#include <cpp-gui/core/gui.hpp>
 
 
 void Widget::on_create() {}
@@ -8,8 +12,11 @@ Widget::~Widget() {
 
     this->release_keyboard_focus();
     this->release_mouse_focus();
+    gui->unqueue_layout(this);
+    gui->undamage_widget(this);
 
-    safe_delete(&this->key);
+    auto& hot_list = gui->mouse.hot_list;
+    hot_list.erase(std::remove(hot_list.begin(), hot_list.end(), this), hot_list.end());
 }
 
 Bool Widget::on_try_match(Def* def) {
@@ -19,7 +26,20 @@ Bool Widget::on_try_match(Def* def) {
 
 void Widget::on_layout(Box_Constraints constraints) { UNUSED(constraints); }
 
-void Widget::on_paint(ID2D1RenderTarget* target) { UNUSED(target); }
+Bool Widget::sized_by_parent() {
+    return false;
+}
+
+void Widget::on_paint(Display_List* list) { UNUSED(list); }
+
+Paint_Bounds Widget::get_paint_bounds() {
+    return Paint_Bounds { V2f { 0, 0 }, this->size };
+}
+
+Range<Uint> Widget::get_children_to_replay(Paint_Bounds visible) {
+    UNUSED(visible);
+    return Range<Uint> { 0, std::numeric_limits<Uint>::max() };
+}
 
 void Widget::on_gain_keyboard_focus() {}
 void Widget::on_lose_keyboard_focus() {}
@@ -32,7 +52,7 @@ Bool Widget::on_hit_test(V2f point) {
     return point >= V2f { 0, 0 } && point < this->size;
 }
 
-Bool Widget::visit_children_for_hit_testing(std::function<Bool(Widget* child)> visitor, V2f point) {
+Bool Widget::visit_children_for_hit_testing(Function_Ref<Bool(Widget* child)> visitor, V2f point) {
     UNUSED(visitor);
     UNUSED(point);
     return false;
@@ -1,11 +1,79 @@
-#include <unordered_map>
+#include <algorithm>
 
 #include <cpp-gui/core/widget.hpp>
+#include <cpp-gui/core/gui.hpp>
+
+
+// Lists with at most this many old widgets are searched linearly.
+static const Uint reconcile_small_list_size = 8;
+
+static const Uint32 no_reconcile_index = ~Uint32(0);
+
+
+// Reused widgets in the longest increasing subsequence of old indices keep
+// their relative order. The others are reported as moves.
+static void compute_edit_script(Gui::Reconcile_Scratch* scratch, Reconcile_Edits* edits) {
+    auto& old_indices = scratch->old_indices;
+    auto& tails       = scratch->lis_tails;
+    auto& previous    = scratch->lis_previous;
+    auto& is_stable   = scratch->is_stable;
+
+    auto count = old_indices.size();
+
+    tails.clear();
+    previous.clear();
+    previous.resize(count, no_reconcile_index);
+    is_stable.clear();
+    is_stable.resize(count, 0);
+
+    // tails[k]: New index of the smallest old index that ends an increasing
+    // subsequence of length k + 1.
+    for(Uint new_index = 0; new_index < count; new_index += 1) {
+        auto old_index = old_indices[new_index];
+        if(old_index == no_reconcile_index) {
+            edits->inserts.push_back(Uint32(new_index));
+            continue;
+        }
+
+        auto it = std::lower_bound(tails.begin(), tails.end(), old_index,
+            [&](Uint32 tail, Uint32 value) { return old_indices[tail] < value; }
+        );
+
+        if(it != tails.begin()) {
+            previous[new_index] = *(it - 1);
+        }
+
+        if(it == tails.end()) {
+            tails.push_back(Uint32(new_index));
+        }
+        else {
+            *it = Uint32(new_index);
+        }
+    }
+
+    if(tails.empty() == false) {
+        auto at = tails.back();
+        while(at != no_reconcile_index) {
+            is_stable[at] = 1;
+            at = previous[at];
+        }
+    }
+
+    for(Uint new_index = 0; new_index < count; new_index += 1) {
+        auto old_index = old_indices[new_index];
+        if(old_index != no_reconcile_index && is_stable[new_index] == 0) {
+            edits->moves.push_back({ old_index, Uint32(new_index) });
+        }
+    }
+
+    std::sort(edits->removes.begin(), edits->removes.end());
+}
 
 
 void Widget::become_parent(Widget* child) {
     // detect widgets created with new.
     assert(child->gui != nullptr);
+    assert(child->is_buried == false);
 
     assert(child->parent == nullptr);
 
@@ -40,7 +108,14 @@ void Widget::drop(Widget* child) {
             // owner and parent -> destroy.
             child->owner  = nullptr;
             child->parent = nullptr;
-            delete child;
+
+            if(this->is_buried) {
+                // Already unlinked with this widget.
+                child->gui->add_to_graveyard(child);
+            }
+            else {
+                child->gui->bury_widget(child);
+            }
         }
     }
     else if(child->parent == this) {
@@ -62,16 +137,46 @@ void Widget::drop_maybe(Widget* child) {
 
 Bool Widget::try_match(Def* def) {
     // @widget-def-ignore-keys
-    auto widget_def = dynamic_cast<Widget_Def*>(def);
+    auto widget_def = fast_cast<Widget_Def>(def);
     if(widget_def != nullptr) {
         return this == widget_def->widget;
     }
 
-    auto keys_match =
-           (def->key == nullptr && this->key == nullptr)
-        || (def->key != nullptr && def->key->equal_to(this->key));
+    auto keys_match = def->key == this->key;
+    if(keys_match == false) {
+        return false;
+    }
+
+    // Same def as last time -> skip the subtree.
+    //  - note: Compares type_info addresses, not type_infos (their == may
+    //    compare names). A type with two type_infos (eg: across DLLs) only
+    //    misses the memo.
+    auto is_memoized =
+           def->has_memo
+        && this->memo_def_type != nullptr
+        && this->memo == def->memo
+        && this->memo_def_type == &typeid(*def);
+    if(is_memoized) {
+        return true;
+    }
 
-    return keys_match && this->on_try_match(def);
+    if(this->on_try_match(def)) {
+        this->set_memo(def);
+        return true;
+    }
+
+    return false;
+}
+
+void Widget::set_memo(Def* def) {
+    if(def->has_memo) {
+        this->memo          = def->memo;
+        this->memo_def_type = &typeid(*def);
+    }
+    else {
+        this->memo          = 0;
+        this->memo_def_type = nullptr;
+    }
 }
 
 
@@ -79,13 +184,23 @@ Widget* Widget::reconcile(
         Widget* old_widget, Def* new_def,
         New_Child_Action new_child_action
 ) {
-    if(old_widget != nullptr && old_widget->try_match(new_def)) {
+    auto matched = false;
+    if(old_widget != nullptr) {
+        gui->recurse([&]() { matched = old_widget->try_match(new_def); });
+    }
+
+    if(matched) {
         return old_widget;
     }
     else {
         this->drop_maybe(old_widget);
 
-        auto new_widget = new_def->get_widget(gui);
+        auto new_widget = (Widget*)nullptr;
+        gui->recurse([&]() { new_widget = new_def->get_widget(gui); });
+
+        // New child -> our layout is outdated. (Matched children mark
+        // themselves if they change.)
+        this->mark_for_layout();
 
         if(new_child_action == New_Child_Action::become_parent) {
             this->become_parent(new_widget);
@@ -104,63 +219,128 @@ Widget* Widget::reconcile(
 
 List<Widget*> Widget::reconcile_list(
     List<Widget*>& old_widgets, const List<Def*>& new_defs,
-    New_Child_Action new_child_action
+    New_Child_Action new_child_action,
+    Reconcile_Edits* edits
 ) {
+    // Do any defs refer to old widgets?
+    auto has_references = false;
+    for(auto new_def : new_defs) {
+        // @widget-def-ignore-keys
+        if(new_def->key.is_none() == false || fast_cast<Widget_Def>(new_def) != nullptr) {
+            has_references = true;
+            break;
+        }
+    }
+
+    // Small lists are searched linearly. Larger ones use the Gui's scratch
+    // tables.
+    auto use_tables = has_references && old_widgets.size() > reconcile_small_list_size;
+
+    auto scratch = (Gui::Reconcile_Scratch*)nullptr;
+    if(use_tables || edits != nullptr) {
+        scratch = this->gui->push_reconcile_scratch();
+    }
+
     // NOTE(llw): Populate maps.
-    auto widget_to_index = std::unordered_map<Widget*,     Uint>();
-    auto key_to_index    = std::unordered_map<Key_Pointer, Uint>();
-    for(Uint index = 0; index < old_widgets.size(); index += 1) {
-        auto widget = old_widgets[index];
+    if(use_tables) {
+        scratch->widget_to_index.begin(old_widgets.size());
+        scratch->key_to_index.begin(old_widgets.size());
 
-        widget_to_index.insert({ widget, index });
+        for(Uint index = 0; index < old_widgets.size(); index += 1) {
+            auto widget = old_widgets[index];
 
-        if(widget->key != nullptr) {
-            key_to_index.insert({ Key_Pointer(widget->key), index });
+            scratch->widget_to_index.insert(widget, Uint32(index));
+
+            if(widget->key.is_none() == false) {
+                scratch->key_to_index.insert(widget->key, Uint32(index));
+            }
         }
     }
 
-    auto get_old_widget_by_index_and_mark_as_used = [&](Uint old_index) {
-        auto old_widget = old_widgets[old_index];
-        assert(old_widget != nullptr);
+    if(edits != nullptr) {
+        edits->clear();
+        scratch->old_indices.clear();
+        scratch->old_indices.resize(new_defs.size(), no_reconcile_index);
+    }
 
-        old_widgets[old_index] = nullptr;
-        return old_widget;
+    auto find_old_index_by_pointer = [&](Widget* widget) {
+        if(use_tables) {
+            auto index = scratch->widget_to_index.find(widget);
+            if(index != nullptr) {
+                return *index;
+            }
+        }
+        else {
+            for(Uint index = 0; index < old_widgets.size(); index += 1) {
+                if(old_widgets[index] == widget) {
+                    return Uint32(index);
+                }
+            }
+        }
+        return no_reconcile_index;
+    };
+
+    auto find_old_index_by_key = [&](const Key& key) {
+        if(use_tables) {
+            auto index = scratch->key_to_index.find(key);
+            if(index != nullptr) {
+                return *index;
+            }
+        }
+        else {
+            for(Uint index = 0; index < old_widgets.size(); index += 1) {
+                auto widget = old_widgets[index];
+                if(widget != nullptr && widget->key == key) {
+                    return Uint32(index);
+                }
+            }
+        }
+        return no_reconcile_index;
     };
 
 
     auto new_widgets = List<Widget*> {};
     new_widgets.resize(new_defs.size());
 
+    auto reconcile_def = [&](Uint def_index, Uint32 old_index) {
+        auto old_widget = (Widget*)nullptr;
+        if(old_index != no_reconcile_index) {
+            old_widget = old_widgets[old_index];
+            assert(old_widget != nullptr);
+
+            // Mark as used.
+            old_widgets[old_index] = nullptr;
+        }
+
+        auto new_widget = this->reconcile(old_widget, new_defs[def_index], new_child_action);
+        new_widgets[def_index] = new_widget;
+
+        if(edits != nullptr) {
+            if(old_widget != nullptr && new_widget == old_widget) {
+                scratch->old_indices[def_index] = old_index;
+            }
+            else if(old_widget != nullptr) {
+                edits->removes.push_back(old_index);
+            }
+        }
+    };
+
     // Process widget and keyed defs first.
     //  Otherwise, the referenced widgets could be reconciled against defs
     //  earlier in the list:
     //   - new_defs[1] references old_children[0].
     //   - but new_defs[0] is processed first and is reconciled against
     //     old_children[0].
-    for(Uint def_index = 0; def_index < new_defs.size(); def_index += 1) {
+    for(Uint def_index = 0; has_references && def_index < new_defs.size(); def_index += 1) {
         auto new_def = new_defs[def_index];
 
         // @widget-def-ignore-keys
-        auto widget_def = dynamic_cast<Widget_Def*>(new_def);
+        auto widget_def = fast_cast<Widget_Def>(new_def);
         if(widget_def != nullptr) {
-            auto old_widget = (Widget*)nullptr;
-
-            auto it = widget_to_index.find(widget_def->widget);
-            if(it != widget_to_index.end()) {
-                old_widget = get_old_widget_by_index_and_mark_as_used(it->second);
-            }
-
-            new_widgets[def_index] = this->reconcile(old_widget, new_def, new_child_action);
+            reconcile_def(def_index, find_old_index_by_pointer(widget_def->widget));
         }
-        else if(new_def->key != nullptr) {
-            auto old_widget = (Widget*)nullptr;
-
-            auto it = key_to_index.find(new_def->key);
-            if(it != key_to_index.end()) {
-                old_widget = get_old_widget_by_index_and_mark_as_used(it->second);
-            }
-
-            new_widgets[def_index] = this->reconcile(old_widget, new_def, new_child_action);
+        else if(new_def->key.is_none() == false) {
+            reconcile_def(def_index, find_old_index_by_key(new_def->key));
         }
 
         // NOTE(llw): The above calls to reconcile will do some redundant work
@@ -175,32 +355,44 @@ List<Widget*> Widget::reconcile_list(
     auto old_cursor = Uint(0);
 
     for(Uint def_index = 0; def_index < new_defs.size(); def_index += 1) {
-        auto new_def = new_defs[def_index];
-
         // Def already processed?
         if(new_widgets[def_index] != nullptr) {
             continue;
         }
 
         // Find first unused old widget.
-        auto old_widget = (Widget*)nullptr;
+        auto old_index = no_reconcile_index;
         while(old_cursor < old_widgets.size()) {
-            auto& at = old_widgets[old_cursor];
+            auto at = old_cursor;
             old_cursor += 1;
 
-            if(at != nullptr) {
-                old_widget = at;
-                at = nullptr;
+            if(old_widgets[at] != nullptr) {
+                old_index = Uint32(at);
                 break;
             }
         }
 
-        new_widgets[def_index] = this->reconcile(old_widget, new_def, new_child_action);
+        reconcile_def(def_index, old_index);
     }
 
     // Drop remaining old widgets.
     for(; old_cursor < old_widgets.size(); old_cursor += 1) {
-        this->drop_maybe(old_widgets[old_cursor]);
+        auto old_widget = old_widgets[old_cursor];
+        if(old_widget != nullptr) {
+            this->drop(old_widget);
+
+            if(edits != nullptr) {
+                edits->removes.push_back(Uint32(old_cursor));
+            }
+        }
+    }
+
+    if(edits != nullptr) {
+        compute_edit_script(scratch, edits);
+    }
+
+    if(scratch != nullptr) {
+        this->gui->pop_reconcile_scratch();
     }
 
     return new_widgets;
@@ -0,0 +1,80 @@
+#include <cstddef>
+#include <new>
+
+#include <cpp-gui/core/widget_pool.hpp>
+
+
+static const Uint slab_bytes       = 16*1024;
+static const Uint min_slab_objects = 8;
+
+
+void Widget_Pool::create(const char* type_name, Uint object_size, Uint object_align) {
+    // Slabs come from operator new.
+    assert(object_align <= alignof(std::max_align_t));
+
+    // Free objects store the next free object.
+    object_size = max(object_size, Uint(sizeof(void*)));
+    object_size = aligned_pointer(object_size, object_align);
+
+    this->type_name        = type_name;
+    this->object_size      = object_size;
+    this->objects_per_slab = max(slab_bytes / object_size, min_slab_objects);
+
+    this->slabs.clear();
+    this->free_list = nullptr;
+
+    this->live_count       = 0;
+    this->peak_count       = 0;
+    this->allocation_count = 0;
+}
+
+void Widget_Pool::destroy() {
+    // Widgets that are still alive were leaked by their owners.
+    for(auto slab : this->slabs) {
+        ::operator delete(slab);
+    }
+    this->slabs.clear();
+    this->free_list = nullptr;
+}
+
+
+void* Widget_Pool::allocate() {
+    if(this->free_list == nullptr) {
+        auto slab = (Uint8*)::operator new(this->objects_per_slab * this->object_size);
+        this->slabs.push_back(slab);
+
+        // Thread the slab onto the free list. First object first.
+        for(Uint i = this->objects_per_slab; i > 0; i -= 1) {
+            auto object = slab + (i - 1)*this->object_size;
+            *(void**)object = this->free_list;
+            this->free_list = object;
+        }
+    }
+
+    auto object = this->free_list;
+    this->free_list = *(void**)object;
+
+    this->live_count += 1;
+    this->peak_count  = max(this->peak_count, this->live_count);
+    this->allocation_count += 1;
+
+    return object;
+}
+
+void Widget_Pool::free(void* object) {
+    assert(this->live_count > 0);
+    this->live_count -= 1;
+
+    *(void**)object = this->free_list;
+    this->free_list = object;
+}
+
+
+static Uint next_widget_pool_index = 0;
+
+Uint allocate_widget_pool_index() {
+    auto index = next_widget_pool_index;
+    next_widget_pool_index += 1;
+    return index;
+}
+
@@ -0,0 +1,563 @@
+#include <cmath>
+
+#include <cpp-gui/cpu_backend.hpp>
+#include <cpp-gui/shadow_kernel.hpp>
+#include <cpp-gui/rounded_rect_kernel.hpp>
+#include <cpp-gui/premultiplied.hpp>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+    #include <emmintrin.h>
+    #define CPU_BACKEND_SSE2 1
+#else
+    #define CPU_BACKEND_SSE2 0
+#endif
+
+
+void CPU_Backend::create(Uint32 width, Uint32 height) {
+    this->width  = width;
+    this->height = height;
+    this->pixels.assign(Uint(width)*Uint(height), 0);
+
+    this->transform = Paint_Transform::translation(V2f { 0, 0 });
+    this->clip      = Pixel_Rect { 0, 0, Sint32(width), Sint32(height) };
+    this->clip_stack.clear();
+}
+
+void CPU_Backend::destroy() {
+    this->width  = 0;
+    this->height = 0;
+    this->pixels = List<Uint32>();
+    this->clip   = Pixel_Rect {};
+    this->clip_stack.clear();
+}
+
+
+
+// Pixel operations.
+//  - Colors are packed premultiplied RGBA8, R in the lowest byte. See
+//    premultiplied.hpp.
+//  - The SIMD and scalar paths compute the same values (bit for bit).
+
+static void fill_span(Uint32* dest, Uint count, Uint32 color) {
+    auto i = Uint(0);
+
+#if CPU_BACKEND_SSE2
+    auto color4 = _mm_set1_epi32((int)color);
+    for(; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)(dest + i), color4);
+    }
+#endif
+
+    for(; i < count; i += 1) {
+        dest[i] = color;
+    }
+}
+
+static void blend_span(Uint32* dest, Uint count, Uint32 source) {
+    auto alpha = source >> 24;
+    if(alpha == 255) {
+        fill_span(dest, count, source);
+        return;
+    }
+    if(source == 0) {
+        return;
+    }
+
+    auto i = Uint(0);
+
+#if CPU_BACKEND_SSE2
+    auto zero          = _mm_setzero_si128();
+    auto source4       = _mm_set1_epi32((int)source);
+    auto inverse_alpha = _mm_set1_epi16((short)(255 - alpha));
+    auto round         = _mm_set1_epi16(128);
+
+    // 16 bit lanes: div_255(d*inverse_alpha).
+    auto scale = [&](__m128i d) {
+        auto x = _mm_add_epi16(_mm_mullo_epi16(d, inverse_alpha), round);
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    };
+
+    for(; i + 4 <= count; i += 4) {
+        auto d  = _mm_loadu_si128((const __m128i*)(dest + i));
+        auto lo = scale(_mm_unpacklo_epi8(d, zero));
+        auto hi = scale(_mm_unpackhi_epi8(d, zero));
+        auto result = _mm_adds_epu8(_mm_packus_epi16(lo, hi), source4);
+        _mm_storeu_si128((__m128i*)(dest + i), result);
+    }
+#endif
+
+    for(; i < count; i += 1) {
+        dest[i] = blend(dest[i], source);
+    }
+}
+
+
+
+// Rounded rects.
+
+static Float32 get_scale(const Paint_Transform& transform) {
+    return sqrtf(fabsf(transform.x_axis.x*transform.y_axis.y - transform.x_axis.y*transform.y_axis.x));
+}
+
+static CPU_Backend::Shape to_shape(const Paint_Transform& transform, V2f rect_min, V2f rect_max, Float32 radius) {
+    auto bounds = Paint_Bounds { rect_min, rect_max }.transformed(transform);
+
+    // Other transforms get no corners.
+    auto is_axis_aligned = transform.x_axis.y == 0.0f && transform.y_axis.x == 0.0f;
+    return Rounded_Rect_Kernel::make_shape(bounds.min, bounds.max, is_axis_aligned ? radius*get_scale(transform) : 0.0f);
+}
+
+// Half width of the region where the distance is <= -inset, in the row at
+// `y`. Negative if the row misses it.
+//  - The region is the shape shrunk by `inset`: Its radius shrinks too, down
+//    to 0.
+static Float32 get_inner_half_width(const CPU_Backend::Shape& shape, Float32 y, Float32 inset) {
+    auto half_size = shape.half_size - V2f(inset);
+    auto radius    = max(shape.radius - inset, 0.0f);
+
+    auto dy = fabsf(y - shape.center.y);
+    if(dy > half_size.y) {
+        return -1.0f;
+    }
+
+    auto corner_y = dy - (half_size.y - radius);
+    if(corner_y <= 0.0f) {
+        return half_size.x;
+    }
+
+    return half_size.x - radius + sqrtf(max(radius*radius - corner_y*corner_y, 0.0f));
+}
+
+// `value` clamped to [low, high], then converted. Clamping first keeps the
+// conversion defined for huge values. NaN becomes `low`.
+static Sint32 clamp_to_pixels(Float32 value, Sint32 low, Sint32 high) {
+    if(!(value > Float32(low))) {
+        return low;
+    }
+    if(value >= Float32(high)) {
+        return high;
+    }
+    return Sint32(value);
+}
+
+// Pixel centers of the row at `y` that are at least `inset` inside the shape.
+static void get_inner_span(
+    const CPU_Backend::Shape& shape, Float32 inset, Sint32 y, CPU_Backend::Pixel_Rect clip,
+    Sint32* begin, Sint32* end
+) {
+    *begin = clip.x1;
+    *end   = clip.x1;
+
+    auto half_width = get_inner_half_width(shape, Float32(y) + 0.5f, inset);
+    if(half_width >= 0.0f) {
+        *begin = clamp_to_pixels(ceilf(shape.center.x - half_width - 0.5f),         clip.x0, clip.x1);
+        *end   = clamp_to_pixels(floorf(shape.center.x + half_width - 0.5f) + 1.0f, *begin,  clip.x1);
+    }
+}
+
+// How far coverage reaches beyond the shape's edge.
+static Float32 get_reach(const CPU_Backend::Command& command) {
+    switch(command.type) {
+        case CPU_Backend::Command_Type::rounded_rect: {
+            return command.stroke_color != 0 ? max(command.stroke_half_width + 0.5f, 0.5f) : 0.5f;
+        }
+        case CPU_Backend::Command_Type::blur: return max(command.blur_radius, 0.5f);
+        default:                              return 0.5f;
+    }
+}
+
+// Paints a fill and stroke with Rounded_Rect_Kernel.
+//  - Pixels in the inner region are fully covered by the fill and not
+//    touched by the stroke, so they're blended as spans. Whether a pixel is
+//    inner doesn't depend on the clip, so tiles match.
+static void raster_rounded_rect(
+    Uint32* pixels, Uint32 stride, CPU_Backend::Pixel_Rect clip,
+    const Rounded_Rect_Kernel& kernel, Rounded_Rect_Kernel::Level level
+) {
+    // Inside the stroke's inner edge (the stroke shape is inside the fill
+    // shape), or the fill's anti-aliased edge.
+    auto has_stroke  = kernel.stroke_color != 0;
+    auto inner_shape = has_stroke ? kernel.stroke_shape : kernel.fill_shape;
+    auto inner_inset = has_stroke ? kernel.stroke_half_width + 0.5f : 0.5f;
+
+    for(auto y = clip.y0; y < clip.y1; y += 1) {
+        auto row = pixels + Uint(y)*stride;
+
+        auto inner_begin = Sint32(0);
+        auto inner_end   = Sint32(0);
+        get_inner_span(inner_shape, inner_inset, y, clip, &inner_begin, &inner_end);
+
+        kernel.blend_span(level, row, clip.x0, y, Uint(inner_begin - clip.x0));
+        if(kernel.fill_color != 0) {
+            blend_span(row + inner_begin, Uint(inner_end - inner_begin), kernel.fill_color);
+        }
+        kernel.blend_span(level, row, inner_end, y, Uint(clip.x1 - inner_end));
+    }
+}
+
+// Paints a blurred shape with Shadow_Kernel.
+//  - Pixels whose blur window (a square of `blur_radius` around them) is
+//    inside the shape are fully covered and filled as spans.
+static void raster_shadow(
+    Uint32* pixels, Uint32 stride, CPU_Backend::Pixel_Rect clip,
+    const CPU_Backend::Shape& shape, Uint32 color, Float32 blur_radius
+) {
+    auto kernel = Shadow_Kernel {};
+    kernel.create(shape.center, shape.half_size, shape.radius, blur_radius);
+
+    auto inner_inset = blur_radius*sqrtf(2.0f);
+
+    auto paint_pixels = [&](Uint32* row, const Shadow_Kernel::Row& kernel_row, Sint32 begin, Sint32 end) {
+        Uint8 coverage[256];
+
+        for(auto x = begin; x < end; x += 256) {
+            auto count = Uint(min(end - x, 256));
+            kernel.get_span_coverage(kernel_row, x, count, coverage);
+
+            for(Uint i = 0; i < count; i += 1) {
+                if(coverage[i] != 0) {
+                    row[x + Sint32(i)] = blend(row[x + Sint32(i)], scale_color(color, coverage[i]));
+                }
+            }
+        }
+    };
+
+    for(auto y = clip.y0; y < clip.y1; y += 1) {
+        auto row = pixels + Uint(y)*stride;
+
+        auto inner_begin = Sint32(0);
+        auto inner_end   = Sint32(0);
+        get_inner_span(shape, inner_inset, y, clip, &inner_begin, &inner_end);
+
+        auto kernel_row = kernel.get_row(Float32(y) + 0.5f);
+        paint_pixels(row, kernel_row, clip.x0, inner_begin);
+        blend_span(row + inner_begin, Uint(inner_end - inner_begin), color);
+        paint_pixels(row, kernel_row, inner_end, clip.x1);
+    }
+}
+
+
+Uint64 CPU_Backend::execute(const Command& command, Pixel_Rect region) {
+    auto clip = Pixel_Rect {
+        max(command.bounds.x0, region.x0), max(command.bounds.y0, region.y0),
+        min(command.bounds.x1, region.x1), min(command.bounds.y1, region.y1),
+    };
+    if(clip.x0 >= clip.x1 || clip.y0 >= clip.y1) {
+        return 0;
+    }
+
+    auto pixels = this->pixels.data();
+    auto stride = this->width;
+
+    switch(command.type) {
+        case Command_Type::clear: {
+            for(auto y = clip.y0; y < clip.y1; y += 1) {
+                fill_span(pixels + Uint(y)*stride + Uint(clip.x0), Uint(clip.x1 - clip.x0), command.color);
+            }
+        } break;
+
+        case Command_Type::rounded_rect: {
+            auto kernel = Rounded_Rect_Kernel {};
+            kernel.fill_shape        = command.shape;
+            kernel.fill_color        = command.color;
+            kernel.stroke_shape      = command.stroke_shape;
+            kernel.stroke_color      = command.stroke_color;
+            kernel.stroke_half_width = command.stroke_half_width;
+            raster_rounded_rect(pixels, stride, clip, kernel, this->kernel_level);
+        } break;
+
+        // The blur reaches `blur_radius` beyond the edge (3 standard
+        // deviations, like Shadow_Cache).
+        case Command_Type::blur: {
+            if(command.blur_radius <= 0.0f) {
+                auto kernel = Rounded_Rect_Kernel {};
+                kernel.fill_shape = command.shape;
+                kernel.fill_color = command.color;
+                raster_rounded_rect(pixels, stride, clip, kernel, this->kernel_level);
+                break;
+            }
+
+            raster_shadow(pixels, stride, clip, command.shape, command.color, command.blur_radius);
+        } break;
+
+        case Command_Type::mask: {
+            for(auto y = clip.y0; y < clip.y1; y += 1) {
+                auto row      = pixels + Uint(y)*stride;
+                auto mask_row = &this->mask_data[command.mask_offset + Uint(y - command.mask_y)*command.mask_stride];
+
+                for(auto x = clip.x0; x < clip.x1; x += 1) {
+                    auto coverage = Uint32(mask_row[x - command.mask_x]);
+                    if(coverage != 0) {
+                        row[x] = blend(row[x], scale_color(command.color, coverage));
+                    }
+                }
+            }
+        } break;
+    }
+
+    return Uint64(clip.x1 - clip.x0)*Uint64(clip.y1 - clip.y0);
+}
+
+
+void CPU_Backend::submit(const Command& command) {
+    if(command.bounds.x0 >= command.bounds.x1 || command.bounds.y0 >= command.bounds.y1) {
+        return;
+    }
+
+    if(this->tiled) {
+        this->commands.push_back(command);
+    }
+    else {
+        auto everything = Pixel_Rect { 0, 0, Sint32(this->width), Sint32(this->height) };
+        this->pixel_count += this->execute(command, everything);
+    }
+}
+
+// Submits a rounded rect or blur command. Bounds are clipped to the clip.
+//  - Huge shapes (like an unconstrained size) are clamped in floats, before
+//    the conversion. Shapes with NaNs are skipped.
+static void submit_shape(CPU_Backend* backend, CPU_Backend::Command command) {
+    auto& shape = command.shape;
+    if(!(shape.half_size.x >= 0.0f && shape.half_size.y >= 0.0f)) {
+        return;
+    }
+
+    auto extent = shape.half_size + V2f(get_reach(command));
+    auto low    = shape.center - extent;
+    auto high   = shape.center + extent;
+    if(!(low.x <= high.x && low.y <= high.y)) {
+        return;
+    }
+
+    auto clip = backend->clip;
+    command.bounds = CPU_Backend::Pixel_Rect {
+        clamp_to_pixels(floorf(low.x), clip.x0, clip.x1),
+        clamp_to_pixels(floorf(low.y), clip.y0, clip.y1),
+        clamp_to_pixels(ceilf(high.x), clip.x0, clip.x1),
+        clamp_to_pixels(ceilf(high.y), clip.y0, clip.y1),
+    };
+
+    backend->submit(command);
+}
+
+
+
+V2f CPU_Backend::get_size() {
+    return V2f { Float32(this->width), Float32(this->height) };
+}
+
+
+Paint_Transform CPU_Backend::get_transform() {
+    return this->transform;
+}
+
+void CPU_Backend::set_transform(const Paint_Transform& transform) {
+    this->transform = transform;
+}
+
+
+void CPU_Backend::push_clip(Paint_Bounds bounds, Bool aliased) {
+    UNUSED(aliased);
+
+    // Pixels whose centers are inside. Clamped to the current clip in floats
+    // first, like submit_shape.
+    auto pixels = bounds.transformed(this->transform);
+
+    this->clip_stack.push_back(this->clip);
+
+    auto& clip = this->clip;
+    clip.x0 = clamp_to_pixels(floorf(pixels.min.x + 0.5f), clip.x0, clip.x1);
+    clip.y0 = clamp_to_pixels(floorf(pixels.min.y + 0.5f), clip.y0, clip.y1);
+    clip.x1 = clamp_to_pixels(floorf(pixels.max.x + 0.5f), clip.x0, clip.x1);
+    clip.y1 = clamp_to_pixels(floorf(pixels.max.y + 0.5f), clip.y0, clip.y1);
+}
+
+void CPU_Backend::pop_clip() {
+    assert(this->clip_stack.empty() == false);
+    this->clip = this->clip_stack.back();
+    this->clip_stack.pop_back();
+}
+
+
+void CPU_Backend::clear(V4f color) {
+    auto command = Command {};
+    command.type   = Command_Type::clear;
+    command.color  = pack_premultiplied(color);
+    command.bounds = this->clip;
+    this->submit(command);
+}
+
+
+void CPU_Backend::fill_rounded_rect(const Paint_Rounded_Rect& rect) {
+    auto command = Command {};
+    command.type         = Command_Type::rounded_rect;
+    command.color        = pack_premultiplied(rect.color);
+    command.shape        = to_shape(this->transform, rect.min, rect.max, rect.radius);
+    command.stroke_shape = command.shape;
+
+    if(command.color != 0) {
+        submit_shape(this, command);
+    }
+}
+
+// 1px (scaled by the transform), centered on the edge.
+void CPU_Backend::stroke_rounded_rect(const Paint_Rounded_Rect& rect) {
+    auto command = Command {};
+    command.type              = Command_Type::rounded_rect;
+    command.shape             = to_shape(this->transform, rect.min, rect.max, rect.radius);
+    command.stroke_shape      = command.shape;
+    command.stroke_color      = pack_premultiplied(rect.color);
+    command.stroke_half_width = 0.5f*get_scale(this->transform);
+
+    if(command.stroke_color != 0) {
+        submit_shape(this, command);
+    }
+}
+
+void CPU_Backend::solid_rounded_rect(const Paint_Solid_Rounded_Rect& rect) {
+    auto command = Command {};
+    command.type              = Command_Type::rounded_rect;
+    command.color             = pack_premultiplied(rect.fill_color);
+    command.shape             = to_shape(this->transform, rect.min, rect.max, rect.radius);
+    command.stroke_shape      = to_shape(this->transform, rect.min + V2f(0.5f), rect.max - V2f(0.5f), rect.radius);
+    command.stroke_color      = pack_premultiplied(rect.stroke_color);
+    command.stroke_half_width = 0.5f*get_scale(this->transform);
+
+    // note: Like stroke_rounded_rect, which skips negative sizes.
+    if(command.stroke_shape.half_size.x < 0.0f || command.stroke_shape.half_size.y < 0.0f) {
+        command.stroke_color = 0;
+    }
+
+    if(command.color != 0 || command.stroke_color != 0) {
+        submit_shape(this, command);
+    }
+}
+
+void CPU_Backend::blurred_rounded_rect(const Paint_Blurred_Rounded_Rect& shadow) {
+    auto command = Command {};
+    command.type        = Command_Type::blur;
+    command.color       = pack_premultiplied(shadow.color);
+    command.shape       = to_shape(this->transform, shadow.min, shadow.max, shadow.corner_radius);
+    command.blur_radius = shadow.blur_radius*get_scale(this->transform);
+
+    if(command.color != 0) {
+        submit_shape(this, command);
+    }
+}
+
+
+void CPU_Backend::glyph_run(const Paint_Glyph_Run& run) {
+    if(this->glyph_hook) {
+        auto pixel_run = run;
+        pixel_run.position =
+              run.position.x*this->transform.x_axis
+            + run.position.y*this->transform.y_axis
+            + this->transform.offset;
+        this->glyph_hook(this, pixel_run);
+    }
+}
+
+
+void CPU_Backend::blend_mask(
+    Sint32 x, Sint32 y, Uint32 mask_width, Uint32 mask_height,
+    const Uint8* mask, Uint mask_stride, V4f color
+) {
+    auto command = Command {};
+    command.type   = Command_Type::mask;
+    command.color  = pack_premultiplied(color);
+    command.mask_x = x;
+    command.mask_y = y;
+    command.bounds = Pixel_Rect {
+        max(x, this->clip.x0), max(y, this->clip.y0),
+        min(x + Sint32(mask_width), this->clip.x1), min(y + Sint32(mask_height), this->clip.y1),
+    };
+
+    if(command.bounds.x0 >= command.bounds.x1 || command.bounds.y0 >= command.bounds.y1) {
+        return;
+    }
+
+    // The mask may be gone by the time the command is executed.
+    auto& data = this->mask_data;
+    command.mask_offset = data.size();
+    command.mask_stride = mask_width;
+    for(Uint32 row = 0; row < mask_height; row += 1) {
+        data.insert(data.end(), mask + row*mask_stride, mask + row*mask_stride + mask_width);
+    }
+
+    this->submit(command);
+
+    if(this->tiled == false) {
+        data.clear();
+    }
+}
+
+
+void CPU_Backend::flush() {
+    if(this->tiled == false || this->commands.empty()) {
+        return;
+    }
+
+    auto tile_size  = Sint32(this->tile_size);
+    auto tiles_x    = (Sint32(this->width)  + tile_size - 1) / tile_size;
+    auto tiles_y    = (Sint32(this->height) + tile_size - 1) / tile_size;
+    auto tile_count = Uint(tiles_x*tiles_y);
+
+    // Bin.
+    auto& tile_commands = this->tile_commands;
+    tile_commands.resize(tile_count);
+    for(auto& indices : tile_commands) {
+        indices.clear();
+    }
+
+    for(Uint32 i = 0; i < this->commands.size(); i += 1) {
+        auto& bounds = this->commands[i].bounds;
+
+        auto tx0 = bounds.x0 / tile_size;
+        auto ty0 = bounds.y0 / tile_size;
+        auto tx1 = (bounds.x1 - 1) / tile_size;
+        auto ty1 = (bounds.y1 - 1) / tile_size;
+
+        for(auto ty = ty0; ty <= ty1; ty += 1) {
+            for(auto tx = tx0; tx <= tx1; tx += 1) {
+                tile_commands[Uint(ty*tiles_x + tx)].push_back(i);
+            }
+        }
+    }
+
+    // Rasterize. Tiles don't share pixels.
+    auto& counts = this->tile_pixel_counts;
+    counts.assign(tile_count, 0);
+
+    auto rasterize_tile = [&](Uint tile) {
+        auto tx = Sint32(tile) % tiles_x;
+        auto ty = Sint32(tile) / tiles_x;
+
+        auto region = Pixel_Rect {
+            tx*tile_size, ty*tile_size,
+            min((tx + 1)*tile_size, Sint32(this->width)),
+            min((ty + 1)*tile_size, Sint32(this->height)),
+        };
+
+        auto count = Uint64(0);
+        for(auto index : tile_commands[tile]) {
+            count += this->execute(this->commands[index], region);
+        }
+        counts[tile] = count;
+    };
+
+    if(this->thread_pool != nullptr) {
+        this->thread_pool->run(tile_count, rasterize_tile);
+    }
+    else {
+        for(Uint tile = 0; tile < tile_count; tile += 1) {
+            rasterize_tile(tile);
+        }
+    }
+
+    for(auto count : counts) {
+        this->pixel_count += count;
+    }
+
+    this->commands.clear();
+    this->mask_data.clear();
+}
@@ -0,0 +1,130 @@
+#include <cpp-gui/d2d_backend.hpp>
+#include <cpp-gui/d2d.hpp>
+#include <cpp-gui/text.hpp>
+
+
+void D2D_Backend::release_device_resources() {
+    this->brush_cache.release();
+    this->shadow_cache.release();
+}
+
+
+static D2D1_ROUNDED_RECT to_d2d_rounded_rect(const Paint_Rounded_Rect& rect) {
+    return D2D1::RoundedRect(
+        D2D1::RectF(rect.min.x, rect.min.y, rect.max.x, rect.max.y),
+        rect.radius, rect.radius
+    );
+}
+
+static D2D_MATRIX_3X2_F to_d2d_matrix(const Paint_Transform& transform) {
+    return D2D1::Matrix3x2F(
+        transform.x_axis.x, transform.x_axis.y,
+        transform.y_axis.x, transform.y_axis.y,
+        transform.offset.x, transform.offset.y
+    );
+}
+
+static Paint_Transform from_d2d_matrix(const D2D_MATRIX_3X2_F& matrix) {
+    return Paint_Transform {
+        V2f { matrix._11, matrix._12 },
+        V2f { matrix._21, matrix._22 },
+        V2f { matrix._31, matrix._32 },
+    };
+}
+
+
+V2f D2D_Backend::get_size() {
+    auto size = this->target->GetSize();
+    return V2f { size.width, size.height };
+}
+
+
+Paint_Transform D2D_Backend::get_transform() {
+    auto matrix = D2D_MATRIX_3X2_F {};
+    this->target->GetTransform(&matrix);
+    return from_d2d_matrix(matrix);
+}
+
+void D2D_Backend::set_transform(const Paint_Transform& transform) {
+    this->target->SetTransform(to_d2d_matrix(transform));
+}
+
+
+void D2D_Backend::push_clip(Paint_Bounds bounds, Bool aliased) {
+    this->target->PushAxisAlignedClip(
+        D2D1::RectF(bounds.min.x, bounds.min.y, bounds.max.x, bounds.max.y),
+        aliased ? D2D1_ANTIALIAS_MODE_ALIASED : D2D1_ANTIALIAS_MODE_PER_PRIMITIVE
+    );
+}
+
+void D2D_Backend::pop_clip() {
+    this->target->PopAxisAlignedClip();
+}
+
+
+void D2D_Backend::clear(V4f color) {
+    this->target->Clear(to_d2d_colorf(color));
+}
+
+
+void D2D_Backend::fill_rounded_rect(const Paint_Rounded_Rect& rect) {
+    auto brush = this->brush_cache.get(this->target, rect.color);
+    if(brush != nullptr) {
+        this->target->FillRoundedRectangle(to_d2d_rounded_rect(rect), brush);
+    }
+}
+
+void D2D_Backend::stroke_rounded_rect(const Paint_Rounded_Rect& rect) {
+    auto brush = this->brush_cache.get(this->target, rect.color);
+    if(brush != nullptr) {
+        this->target->DrawRoundedRectangle(to_d2d_rounded_rect(rect), brush);
+    }
+}
+
+
+// Paints a cached shadow bitmap as a nine-patch.
+void D2D_Backend::blurred_rounded_rect(const Paint_Blurred_Rounded_Rect& shadow) {
+    auto entry = this->shadow_cache.get(
+        this->target, shadow.max - shadow.min,
+        shadow.corner_radius, shadow.blur_radius, shadow.color
+    );
+    if(entry == nullptr) {
+        return;
+    }
+
+    auto dest_min  = shadow.min - V2f(entry->padding);
+    auto dest_max  = shadow.max + V2f(entry->padding);
+    auto dest_size = dest_max - dest_min;
+
+    // Patch boundaries. The borders keep their size, the middle stretches.
+    Float32 source_x[4] = { 0, entry->split_min.x, entry->split_max.x, entry->size.x };
+    Float32 source_y[4] = { 0, entry->split_min.y, entry->split_max.y, entry->size.y };
+
+    Float32 dest_x[4] = { 0, entry->split_min.x, dest_size.x - (entry->size.x - entry->split_max.x), dest_size.x };
+    Float32 dest_y[4] = { 0, entry->split_min.y, dest_size.y - (entry->size.y - entry->split_max.y), dest_size.y };
+
+    for(Uint y = 0; y < 3; y += 1) {
+        for(Uint x = 0; x < 3; x += 1) {
+            if(source_x[x + 1] <= source_x[x] || source_y[y + 1] <= source_y[y]) {
+                continue;
+            }
+
+            auto source = D2D1::RectF(source_x[x], source_y[y], source_x[x + 1], source_y[y + 1]);
+            auto dest = D2D1::RectF(
+                dest_min.x + dest_x[x],     dest_min.y + dest_y[y],
+                dest_min.x + dest_x[x + 1], dest_min.y + dest_y[y + 1]
+            );
+
+            this->target->DrawBitmap(entry->bitmap, dest, 1.0f, D2D1_BITMAP_INTERPOLATION_MODE_LINEAR, &source);
+        }
+    }
+}
+
+
+void D2D_Backend::glyph_run(const Paint_Glyph_Run& run) {
+    auto brush = this->brush_cache.get(this->target, run.color);
+    if(brush != nullptr) {
+        run.layout->paint(this->target, run.position, brush);
+    }
+}
+
@@ -0,0 +1,261 @@
+#include <cpp-gui/d2d_cache.hpp>
+#include <cpp-gui/d2d.hpp>
+
+#include <cpp-gui/shadow_kernel.hpp>
+#include <cpp-gui/premultiplied.hpp>
+
+
+static Uint32 quantize_channel(Float32 value) {
+    auto clamped = min(max(value, 0.0f), 1.0f);
+    return (Uint32)(clamped*255.0f + 0.5f);
+}
+
+static Uint32 quantize_color(V4f color) {
+    return (quantize_channel(color.r) << 24)
+         | (quantize_channel(color.g) << 16)
+         | (quantize_channel(color.b) <<  8)
+         | (quantize_channel(color.a) <<  0);
+}
+
+static V4f dequantize_color(Uint32 key) {
+    return make_color(
+        Float32((key >> 24) & 0xff),
+        Float32((key >> 16) & 0xff),
+        Float32((key >>  8) & 0xff),
+        Float32((key >>  0) & 0xff)
+    );
+}
+
+
+ID2D1SolidColorBrush* Brush_Cache::get(ID2D1RenderTarget* target, V4f color) {
+    if(target != this->target) {
+        this->release();
+        this->target = target;
+    }
+
+    auto key = quantize_color(color);
+
+    auto it = this->brushes.find(key);
+    if(it != this->brushes.end()) {
+        this->hit_count += 1;
+        return it->second;
+    }
+
+    this->miss_count += 1;
+
+    if(this->brushes.size() >= this->max_brushes) {
+        this->release_brushes();
+    }
+
+    auto brush = (ID2D1SolidColorBrush*)nullptr;
+    auto hr = target->CreateSolidColorBrush(to_d2d_colorf(dequantize_color(key)), &brush);
+    if(!SUCCEEDED(hr)) {
+        return nullptr;
+    }
+
+    this->brushes.insert({ key, brush });
+    return brush;
+}
+
+
+void Brush_Cache::release() {
+    this->release_brushes();
+    this->target = nullptr;
+}
+
+void Brush_Cache::release_brushes() {
+    for(auto& entry : this->brushes) {
+        entry.second->Release();
+    }
+    this->brushes.clear();
+}
+
+
+
+static Uint32 quantize_length(Float32 value) {
+    return (Uint32)(max(value, 0.0f)*4.0f + 0.5f);
+}
+
+static Float32 dequantize_length(Uint32 value) {
+    return Float32(value)/4.0f;
+}
+
+
+Bool Shadow_Cache::Key::operator==(const Key& other) const {
+    return this->size_x        == other.size_x
+        && this->size_y        == other.size_y
+        && this->corner_radius == other.corner_radius
+        && this->blur_radius   == other.blur_radius
+        && this->color         == other.color;
+}
+
+std::size_t Shadow_Cache::Key_Hash::operator()(const Key& key) const noexcept {
+    auto hash = Uint64(14695981039346656037ull);
+    for(auto value : { key.size_x, key.size_y, key.corner_radius, key.blur_radius, key.color }) {
+        hash = (hash ^ value) * 1099511628211ull;
+    }
+    return (std::size_t)hash;
+}
+
+
+// Evaluates the blurred rounded rect with Shadow_Kernel into a new bitmap.
+//  - The bitmap has the target's DPI, so it isn't resampled when painted.
+static ID2D1Bitmap* create_shadow_bitmap(
+    ID2D1RenderTarget* target, V2f bitmap_size, Float32 padding,
+    V2f rect_size, Float32 corner_radius, Float32 blur_radius, V4f color
+) {
+    auto dpi_x = 96.0f;
+    auto dpi_y = 96.0f;
+    target->GetDpi(&dpi_x, &dpi_y);
+
+    auto scale  = V2f { dpi_x/96.0f, dpi_y/96.0f };
+    auto width  = (Uint32)ceil(bitmap_size.x*scale.x);
+    auto height = (Uint32)ceil(bitmap_size.y*scale.y);
+    if(width == 0 || height == 0) {
+        return nullptr;
+    }
+
+    // Premultiplied BGRA.
+    auto alpha = min(max(color.a, 0.0f), 1.0f);
+    auto r = premultiply_channel(color.r, alpha);
+    auto g = premultiply_channel(color.g, alpha);
+    auto b = premultiply_channel(color.b, alpha);
+    auto a = quantize_coverage(alpha);
+
+    auto pixels   = List<Uint32>(width*height, 0);
+    auto coverage = List<Uint8>(width);
+
+    // The blur is uniform, so non-uniform DPI scale is approximated with
+    // their average.
+    auto average_scale = 0.5f*(scale.x + scale.y);
+
+    auto rect_min = V2f(padding)*scale;
+    auto rect_max = (V2f(padding) + rect_size)*scale;
+    auto center   = 0.5f*(rect_min + rect_max);
+
+    // Unblurred shadows get a minimal blur, which anti-aliases their edges.
+    auto kernel = Shadow_Kernel {};
+    kernel.create(
+        center, 0.5f*(rect_max - rect_min),
+        corner_radius*average_scale, max(blur_radius*average_scale, 0.5f)
+    );
+
+    for(Uint32 y = 0; y < height; y += 1) {
+        kernel.get_span_coverage(kernel.get_row(Float32(y) + 0.5f), 0, width, coverage.data());
+
+        auto row = &pixels[y*width];
+        for(Uint32 x = 0; x < width; x += 1) {
+            auto c = Uint32(coverage[x]);
+            if(c == 0) {
+                continue;
+            }
+
+            row[x] = (div_255(a*c) << 24) | (div_255(r*c) << 16) | (div_255(g*c) << 8) | div_255(b*c);
+        }
+    }
+
+    auto properties = D2D1::BitmapProperties(
+        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED),
+        dpi_x, dpi_y
+    );
+
+    auto result = (ID2D1Bitmap*)nullptr;
+    auto hr = target->CreateBitmap(D2D1::SizeU(width, height), pixels.data(), width*4, properties, &result);
+    if(!SUCCEEDED(hr)) { return nullptr; }
+
+    return result;
+}
+
+
+const Shadow_Cache::Entry* Shadow_Cache::get(
+    ID2D1RenderTarget* target, V2f size,
+    Float32 corner_radius, Float32 blur_radius, V4f color
+) {
+    if(target != this->target) {
+        this->release();
+        this->target = target;
+    }
+
+    // The blur reaches 3 standard deviations (= blur radius) beyond the rect.
+    auto padding = ceil(max(blur_radius, 0.0f));
+
+    // Along an axis, the blurred edge is constant once it is further than the
+    // blur radius from the corners. Rects that are larger than that get a 1px
+    // constant strip in the middle, which is stretched.
+    auto border      = ceil(corner_radius) + padding;
+    auto min_extent  = 2.0f*border + 1.0f;
+    auto stretch_x   = size.x >= min_extent;
+    auto stretch_y   = size.y >= min_extent;
+
+    auto key = Key {};
+    key.size_x        = stretch_x ? 0 : quantize_length(size.x);
+    key.size_y        = stretch_y ? 0 : quantize_length(size.y);
+    key.corner_radius = quantize_length(corner_radius);
+    key.blur_radius   = quantize_length(blur_radius);
+    key.color         = quantize_color(color);
+
+    auto it = this->entries.find(key);
+    if(it != this->entries.end()) {
+        this->hit_count += 1;
+
+        auto& entry = it->second;
+        this->lru.splice(this->lru.begin(), this->lru, entry.lru_position);
+        return &entry;
+    }
+
+    this->miss_count += 1;
+
+    auto rect_size = V2f {
+        stretch_x ? min_extent : dequantize_length(key.size_x),
+        stretch_y ? min_extent : dequantize_length(key.size_y),
+    };
+
+    auto entry = Entry {};
+    entry.size    = rect_size + V2f(2.0f*padding);
+    entry.padding = padding;
+
+    // The splits are at the edges of the constant strip. Exact axes have no
+    // borders and are "stretched" by a quantization error at most.
+    auto split = padding + border;
+    entry.split_min = V2f { stretch_x ? split        : 0.0f,         stretch_y ? split        : 0.0f         };
+    entry.split_max = V2f { stretch_x ? split + 1.0f : entry.size.x, stretch_y ? split + 1.0f : entry.size.y };
+
+    entry.bitmap = create_shadow_bitmap(
+        target, entry.size, padding,
+        rect_size, dequantize_length(key.corner_radius), dequantize_length(key.blur_radius),
+        dequantize_color(key.color)
+    );
+    if(entry.bitmap == nullptr) {
+        return nullptr;
+    }
+
+    entry.bytes = (Uint)ceil(entry.size.x) * (Uint)ceil(entry.size.y) * 4;
+
+    // Make room, but keep at least the new entry.
+    this->evict(this->byte_budget > entry.bytes ? this->byte_budget - entry.bytes : 0);
+
+    this->lru.push_front(key);
+    entry.lru_position = this->lru.begin();
+    this->byte_count += entry.bytes;
+
+    return &this->entries.insert({ key, entry }).first->second;
+}
+
+
+void Shadow_Cache::release() {
+    this->evict(0);
+    this->target = nullptr;
+}
+
+void Shadow_Cache::evict(Uint budget) {
+    while(this->byte_count > budget && this->lru.empty() == false) {
+        auto it = this->entries.find(this->lru.back());
+        assert(it != this->entries.end());
+
+        it->second.bitmap->Release();
+        this->byte_count -= it->second.bytes;
+
+        this->entries.erase(it);
+        this->lru.pop_back();
+    }
+}
@@ -0,0 +1,237 @@
+#include <cmath>
+
+#include <cpp-gui/rounded_rect_kernel.hpp>
+#include <cpp-gui/premultiplied.hpp>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+    #include <emmintrin.h>
+    #define ROUNDED_RECT_KERNEL_SSE2 1
+#else
+    #define ROUNDED_RECT_KERNEL_SSE2 0
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define ROUNDED_RECT_KERNEL_AVX2 1
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #include <immintrin.h>
+    #endif
+#else
+    #define ROUNDED_RECT_KERNEL_AVX2 0
+#endif
+
+
+#if ROUNDED_RECT_KERNEL_AVX2
+// rounded_rect_kernel_avx2.cpp. Returns the number of pixels blended (a
+// multiple of 8).
+Uint blend_rounded_rect_span_avx2(
+    const Rounded_Rect_Kernel& kernel, Float32 fill_qy, Float32 stroke_qy,
+    Uint32* row, Sint32 x, Uint count
+);
+#endif
+
+
+Rounded_Rect_Kernel::Shape Rounded_Rect_Kernel::make_shape(V2f min, V2f max, Float32 radius) {
+    auto shape = Shape {};
+    shape.center    = 0.5f*(min + max);
+    shape.half_size = 0.5f*(max - min);
+    shape.radius    = ::min(::max(radius, 0.0f), ::min(shape.half_size.x, shape.half_size.y));
+    return shape;
+}
+
+
+static Bool is_avx2_supported() {
+#if ROUNDED_RECT_KERNEL_AVX2 && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] < 7) {
+        return false;
+    }
+
+    // The OS must save the YMM registers.
+    __cpuid(info, 1);
+    auto has_osxsave = (info[2] & (1 << 27)) != 0;
+    auto has_avx     = (info[2] & (1 << 28)) != 0;
+    if(has_osxsave == false || has_avx == false || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif ROUNDED_RECT_KERNEL_AVX2
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+Rounded_Rect_Kernel::Level Rounded_Rect_Kernel::get_supported_level() {
+    static auto level =
+          is_avx2_supported()      ? Level::avx2
+        : ROUNDED_RECT_KERNEL_SSE2 ? Level::sse2
+        :                            Level::scalar;
+    return level;
+}
+
+const char* Rounded_Rect_Kernel::get_level_name(Level level) {
+    switch(level) {
+        case Level::scalar: return "scalar";
+        case Level::sse2:   return "sse2";
+        case Level::avx2:   return "avx2";
+    }
+    return "unknown";
+}
+
+
+
+// Distances are split into a row part (qy) and a pixel part. The SIMD
+// kernels do the same operations in the same order.
+
+static Float32 get_row_q(const Rounded_Rect_Kernel::Shape& shape, Sint32 y) {
+    return fabsf(Float32(y) + 0.5f - shape.center.y) - (shape.half_size.y - shape.radius);
+}
+
+static Float32 get_distance(const Rounded_Rect_Kernel::Shape& shape, Float32 qy, Float32 pixel_x) {
+    auto qx = fabsf(pixel_x - shape.center.x) - (shape.half_size.x - shape.radius);
+    auto ox = max(qx, 0.0f);
+    auto oy = max(qy, 0.0f);
+    return sqrtf(ox*ox + oy*oy) + min(max(qx, qy), 0.0f) - shape.radius;
+}
+
+
+#if ROUNDED_RECT_KERNEL_SSE2
+
+static __m128 get_distance_4(const Rounded_Rect_Kernel::Shape& shape, __m128 qy, __m128 pixel_x) {
+    auto sign_mask = _mm_set1_ps(-0.0f);
+    auto zero      = _mm_setzero_ps();
+
+    auto qx = _mm_sub_ps(
+        _mm_andnot_ps(sign_mask, _mm_sub_ps(pixel_x, _mm_set1_ps(shape.center.x))),
+        _mm_set1_ps(shape.half_size.x - shape.radius)
+    );
+    auto ox = _mm_max_ps(qx, zero);
+    auto oy = _mm_max_ps(qy, zero);
+
+    auto length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(ox, ox), _mm_mul_ps(oy, oy)));
+    return _mm_sub_ps(_mm_add_ps(length, _mm_min_ps(_mm_max_ps(qx, qy), zero)), _mm_set1_ps(shape.radius));
+}
+
+static __m128i quantize_coverage_4(__m128 coverage) {
+    auto clamped = _mm_min_ps(_mm_max_ps(coverage, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(clamped, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+}
+
+// 16 bit lanes: div_255(a*b).
+static __m128i multiply_div_255(__m128i a, __m128i b) {
+    auto x = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Blends color*coverage over 2 pixels in 16 bit lanes.
+static __m128i blend_2(__m128i dest, __m128i color, __m128i coverage) {
+    auto source        = multiply_div_255(color, coverage);
+    auto alpha         = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, 0xff), 0xff);
+    auto inverse_alpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+    return _mm_add_epi16(multiply_div_255(dest, inverse_alpha), source);
+}
+
+// Blends color*coverage over 4 pixels.
+static void blend_4(__m128i* dest_lo, __m128i* dest_hi, __m128i color, __m128i coverage) {
+    auto coverage_16 = _mm_packs_epi32(coverage, coverage);
+    auto pairs       = _mm_unpacklo_epi16(coverage_16, coverage_16);
+
+    *dest_lo = blend_2(*dest_lo, color, _mm_unpacklo_epi32(pairs, pairs));
+    *dest_hi = blend_2(*dest_hi, color, _mm_unpackhi_epi32(pairs, pairs));
+}
+
+#endif
+
+
+void Rounded_Rect_Kernel::blend_span(Uint32* row, Sint32 x, Sint32 y, Uint count) const {
+    this->blend_span(get_supported_level(), row, x, y, count);
+}
+
+void Rounded_Rect_Kernel::blend_span(Level level, Uint32* row, Sint32 x, Sint32 y, Uint count) const {
+    if(Uint32(level) > Uint32(get_supported_level())) {
+        level = get_supported_level();
+    }
+
+    auto fill_qy   = get_row_q(this->fill_shape,   y);
+    auto stroke_qy = get_row_q(this->stroke_shape, y);
+    auto hw        = this->stroke_half_width;
+
+    auto i = Uint(0);
+
+#if ROUNDED_RECT_KERNEL_AVX2
+    if(level == Level::avx2) {
+        i = blend_rounded_rect_span_avx2(*this, fill_qy, stroke_qy, row, x, count);
+    }
+#endif
+
+#if ROUNDED_RECT_KERNEL_SSE2
+    if(level != Level::scalar) {
+        auto zero       = _mm_setzero_si128();
+        auto lanes      = _mm_setr_epi32(0, 1, 2, 3);
+        auto fill_16    = _mm_unpacklo_epi8(_mm_set1_epi32((int)this->fill_color),   zero);
+        auto stroke_16  = _mm_unpacklo_epi8(_mm_set1_epi32((int)this->stroke_color), zero);
+        auto fill_qy4   = _mm_set1_ps(fill_qy);
+        auto stroke_qy4 = _mm_set1_ps(stroke_qy);
+
+        for(; i + 4 <= count; i += 4) {
+            auto pixel_x = _mm_add_ps(
+                _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(x + Sint32(i)), lanes)),
+                _mm_set1_ps(0.5f)
+            );
+
+            auto fill_coverage   = zero;
+            auto stroke_coverage = zero;
+
+            if(this->fill_color != 0) {
+                auto distance = get_distance_4(this->fill_shape, fill_qy4, pixel_x);
+                fill_coverage = quantize_coverage_4(_mm_sub_ps(_mm_set1_ps(0.5f), distance));
+            }
+            if(this->stroke_color != 0) {
+                auto distance = _mm_andnot_ps(_mm_set1_ps(-0.0f), get_distance_4(this->stroke_shape, stroke_qy4, pixel_x));
+                stroke_coverage = quantize_coverage_4(_mm_sub_ps(
+                    _mm_min_ps(_mm_add_ps(distance, _mm_set1_ps(0.5f)), _mm_set1_ps(hw)),
+                    _mm_max_ps(_mm_sub_ps(distance, _mm_set1_ps(0.5f)), _mm_set1_ps(-hw))
+                ));
+            }
+
+            if(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_or_si128(fill_coverage, stroke_coverage), zero)) == 0xffff) {
+                continue;
+            }
+
+            auto dest    = _mm_loadu_si128((const __m128i*)(row + x + Sint32(i)));
+            auto dest_lo = _mm_unpacklo_epi8(dest, zero);
+            auto dest_hi = _mm_unpackhi_epi8(dest, zero);
+
+            blend_4(&dest_lo, &dest_hi, fill_16,   fill_coverage);
+            blend_4(&dest_lo, &dest_hi, stroke_16, stroke_coverage);
+
+            _mm_storeu_si128((__m128i*)(row + x + Sint32(i)), _mm_packus_epi16(dest_lo, dest_hi));
+        }
+    }
+#endif
+
+    for(; i < count; i += 1) {
+        auto pixel_x = Float32(x + Sint32(i)) + 0.5f;
+        auto& pixel  = row[x + Sint32(i)];
+
+        if(this->fill_color != 0) {
+            auto distance = get_distance(this->fill_shape, fill_qy, pixel_x);
+            auto coverage = quantize_coverage(0.5f - distance);
+            if(coverage != 0) {
+                pixel = blend(pixel, scale_color(this->fill_color, coverage));
+            }
+        }
+
+        if(this->stroke_color != 0) {
+            auto distance = fabsf(get_distance(this->stroke_shape, stroke_qy, pixel_x));
+            auto coverage = quantize_coverage(min(distance + 0.5f, hw) - max(distance - 0.5f, -hw));
+            if(coverage != 0) {
+                pixel = blend(pixel, scale_color(this->stroke_color, coverage));
+            }
+        }
+    }
+}
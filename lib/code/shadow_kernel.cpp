@@ -0,0 +1,215 @@
+#include <cmath>
+#include <cstring>
+
+#include <cpp-gui/shadow_kernel.hpp>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+    #include <emmintrin.h>
+    #define SHADOW_KERNEL_SSE2 1
+#else
+    #define SHADOW_KERNEL_SSE2 0
+#endif
+
+
+// Abramowitz & Stegun 7.1.27. Absolute error < 5e-4, which is below 8 bit
+// precision.
+static Float32 approximate_erf(Float32 x) {
+    auto a = fabsf(x);
+    auto p = 1.0f + a*(0.278393f + a*(0.230389f + a*(0.000972f + a*0.078108f)));
+    auto p2 = p*p;
+    auto result = 1.0f - 1.0f/(p2*p2);
+    return x < 0.0f ? -result : result;
+}
+
+#if SHADOW_KERNEL_SSE2
+static __m128 approximate_erf(__m128 x) {
+    auto sign_mask = _mm_set1_ps(-0.0f);
+    auto sign = _mm_and_ps(x, sign_mask);
+    auto a    = _mm_andnot_ps(sign_mask, x);
+
+    auto p = _mm_add_ps(_mm_set1_ps(0.000972f), _mm_mul_ps(a, _mm_set1_ps(0.078108f)));
+    p = _mm_add_ps(_mm_set1_ps(0.230389f), _mm_mul_ps(a, p));
+    p = _mm_add_ps(_mm_set1_ps(0.278393f), _mm_mul_ps(a, p));
+    p = _mm_add_ps(_mm_set1_ps(1.0f),      _mm_mul_ps(a, p));
+
+    auto p2 = _mm_mul_ps(p, p);
+    auto result = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_div_ps(_mm_set1_ps(1.0f), _mm_mul_ps(p2, p2)));
+    return _mm_or_ps(result, sign);
+}
+#endif
+
+
+// The Gaussian's mass within the cut off, along one axis. Coverage is
+// divided by it, so that the inside of the rect is fully covered.
+static const Float32 cutoff_erf = approximate_erf(3.0f/sqrtf(2.0f));
+
+
+void Shadow_Kernel::create(V2f center, V2f half_size, Float32 radius, Float32 blur_radius) {
+    assert(blur_radius > 0.0f);
+
+    this->center      = center;
+    this->half_size   = V2f { max(half_size.x, 0.0f), max(half_size.y, 0.0f) };
+    this->radius      = min(max(radius, 0.0f), min(this->half_size.x, this->half_size.y));
+    this->blur_radius = blur_radius;
+    this->erf_scale   = 3.0f/(sqrtf(2.0f)*blur_radius);
+}
+
+
+Shadow_Kernel::Row Shadow_Kernel::get_row(Float32 y) const {
+    auto row = Row {};
+
+    auto dy = y - this->center.y;
+    auto k  = this->erf_scale;
+
+    // Gaussian mass of [y0, y1] (clipped to the cut off).
+    auto window_min = dy - this->blur_radius;
+    auto window_max = dy + this->blur_radius;
+    auto get_mass = [&](Float32 y0, Float32 y1) {
+        return 0.5f*(approximate_erf((y1 - dy)*k) - approximate_erf((y0 - dy)*k))/cutoff_erf;
+    };
+
+    auto straight = this->half_size.y - this->radius;
+
+    // Integral of the corner's x extent, sqrt(r^2 - t^2), from 0 to `t`.
+    auto r = this->radius;
+    auto get_corner_area = [&](Float32 t) {
+        t = min(max(t, 0.0f), r);
+        return 0.5f*(t*sqrtf(max(r*r - t*t, 0.0f)) + r*r*asinf(r > 0.0f ? t/r : 0.0f));
+    };
+
+    auto straight_min = max(-straight, window_min);
+    auto straight_max = min( straight, window_max);
+    row.straight_weight = straight_max > straight_min ? get_mass(straight_min, straight_max) : 0.0f;
+
+    // Corner bands: [-half_size.y, -straight] and [straight, half_size.y].
+    //  - In corner coordinates: t = |y| - straight, from 0 to r.
+    //  - Sliced by arc length, so that neither the width nor the Gaussian
+    //    change much within a slice.
+    auto sigma = this->blur_radius/3.0f;
+
+    for(Uint band = 0; band < 2; band += 1) {
+        auto sign = band == 0 ? -1.0f : 1.0f;
+
+        auto t0 = band == 0 ? -window_max - straight : window_min - straight;
+        auto t1 = band == 0 ? -window_min - straight : window_max - straight;
+        t0 = max(t0, 0.0f);
+        t1 = min(t1, r);
+        if(t1 <= t0) {
+            continue;
+        }
+
+        auto angle0 = r > 0.0f ? asinf(min(t0/r, 1.0f)) : 0.0f;
+        auto angle1 = r > 0.0f ? asinf(min(t1/r, 1.0f)) : 0.0f;
+
+        auto arc_length  = max(r*(angle1 - angle0), t1 - t0);
+        auto slice_count = Uint(min(ceilf(arc_length/(0.5f*sigma)), Float32(max_band_slice_count)));
+        slice_count = max(slice_count, Uint(1));
+
+        auto angle_step = (angle1 - angle0)/Float32(slice_count);
+        auto slice_t0   = t0;
+        for(Uint i = 0; i < slice_count; i += 1) {
+            auto slice_t1 = i + 1 == slice_count ? t1 : r*sinf(angle0 + Float32(i + 1)*angle_step);
+            if(slice_t1 <= slice_t0) {
+                continue;
+            }
+
+            // Average of the corner's x extent over the slice.
+            auto corner_x = (get_corner_area(slice_t1) - get_corner_area(slice_t0))/(slice_t1 - slice_t0);
+
+            auto y0 = sign*(straight + slice_t0);
+            auto y1 = sign*(straight + slice_t1);
+
+            row.half_widths[row.sample_count] = this->half_size.x - this->radius + corner_x;
+            row.weights[row.sample_count]     = get_mass(min(y0, y1), max(y0, y1));
+            row.sample_count += 1;
+
+            slice_t0 = slice_t1;
+        }
+    }
+
+    return row;
+}
+
+
+// Coverage of a row at `dx` from the center, times 2*cutoff_erf.
+//  - The Gaussian's mass over [-half_width, half_width], clipped to the cut
+//    off. The SSE2 version does the same operations in the same order, so
+//    both produce the same bytes.
+static Float32 get_row_coverage(const Shadow_Kernel& kernel, const Shadow_Kernel::Row& row, Float32 dx) {
+    auto k = kernel.erf_scale;
+    auto c = kernel.blur_radius;
+
+    auto get_mass = [&](Float32 half_width) {
+        auto x0 = min(max(0.0f - (half_width + dx), -c), c);
+        auto x1 = min(max(half_width - dx, -c), c);
+        return approximate_erf(x1*k) - approximate_erf(x0*k);
+    };
+
+    auto coverage = 0.0f;
+    if(row.straight_weight > 0.0f) {
+        coverage = row.straight_weight*get_mass(kernel.half_size.x);
+    }
+    for(Uint i = 0; i < row.sample_count; i += 1) {
+        coverage = coverage + row.weights[i]*get_mass(row.half_widths[i]);
+    }
+    return coverage;
+}
+
+
+Float32 Shadow_Kernel::get_coverage(V2f point) const {
+    auto row = this->get_row(point.y);
+    auto coverage = get_row_coverage(*this, row, point.x - this->center.x)*(0.5f/cutoff_erf);
+    return min(max(coverage, 0.0f), 1.0f);
+}
+
+
+void Shadow_Kernel::get_span_coverage(const Row& row, Sint32 x, Uint count, Uint8* coverage) const {
+    auto i = Uint(0);
+
+    #if SHADOW_KERNEL_SSE2
+    {
+        auto k     = _mm_set1_ps(this->erf_scale);
+        auto c     = _mm_set1_ps(this->blur_radius);
+        auto min_c = _mm_set1_ps(-this->blur_radius);
+        auto scale = _mm_set1_ps(0.5f/cutoff_erf*255.0f);
+        auto half   = _mm_set1_ps(0.5f);
+        auto center = _mm_set1_ps(this->center.x);
+        auto lanes  = _mm_setr_epi32(0, 1, 2, 3);
+
+        auto get_mass = [&](__m128 dx, Float32 half_width) {
+            auto w  = _mm_set1_ps(half_width);
+            auto x0 = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(w, dx)), min_c), c);
+            auto x1 = _mm_min_ps(_mm_max_ps(_mm_sub_ps(w, dx), min_c), c);
+            return _mm_sub_ps(approximate_erf(_mm_mul_ps(x1, k)), approximate_erf(_mm_mul_ps(x0, k)));
+        };
+
+        for(; i + 4 <= count; i += 4) {
+            auto pixel_x = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(x + Sint32(i)), lanes));
+            auto dx = _mm_sub_ps(_mm_add_ps(pixel_x, half), center);
+
+            auto sum = _mm_setzero_ps();
+            if(row.straight_weight > 0.0f) {
+                sum = _mm_mul_ps(_mm_set1_ps(row.straight_weight), get_mass(dx, this->half_size.x));
+            }
+            for(Uint j = 0; j < row.sample_count; j += 1) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(row.weights[j]), get_mass(dx, row.half_widths[j])));
+            }
+
+            // Round and clamp to 0-255.
+            auto values = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(sum, scale), half));
+            values = _mm_packs_epi32(values, values);
+            values = _mm_packus_epi16(values, values);
+
+            auto packed = _mm_cvtsi128_si32(values);
+            memcpy(coverage + i, &packed, 4);
+        }
+    }
+    #endif
+
+    auto scale = 0.5f/cutoff_erf*255.0f;
+    for(; i < count; i += 1) {
+        auto dx = Float32(x + Sint32(i)) + 0.5f - this->center.x;
+        auto value = get_row_coverage(*this, row, dx)*scale + 0.5f;
+        coverage[i] = Uint8(min(max(value, 0.0f), 255.0f));
+    }
+}
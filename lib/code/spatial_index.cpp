@@ -0,0 +1,111 @@
+#include <algorithm>
+
+#include <cpp-gui/spatial_index.hpp>
+#include <cpp-gui/core/widget.hpp>
+
+
+static const Uint32 max_leaf_size = 4;
+
+
+static void build_node(Spatial_Index* index, Uint32 node_index, Uint32 begin, Uint32 end) {
+    auto& nodes = index->nodes;
+    auto& items = index->items;
+
+    auto min = V2f(+INFINITY);
+    auto max = V2f(-INFINITY);
+    for(auto i = begin; i < end; i += 1) {
+        min = ::min(min, items[i].min);
+        max = ::max(max, items[i].max);
+    }
+
+    nodes[node_index].min = min;
+    nodes[node_index].max = max;
+
+    auto count = end - begin;
+    if(count <= max_leaf_size) {
+        nodes[node_index].begin = begin;
+        nodes[node_index].count = count;
+        return;
+    }
+
+    // Median split of the centers along the longer axis.
+    auto extent = max - min;
+    auto axis   = extent.x >= extent.y ? 0 : 1;
+
+    auto middle = begin + count/2;
+    std::nth_element(
+        items.begin() + begin, items.begin() + middle, items.begin() + end,
+        [=](const Spatial_Index::Item& a, const Spatial_Index::Item& b) {
+            return a.min[axis] + a.max[axis] < b.min[axis] + b.max[axis];
+        }
+    );
+
+    auto first_child = (Uint32)nodes.size();
+    nodes.push_back({});
+    nodes.push_back({});
+
+    // Note: `nodes` may have been reallocated.
+    nodes[node_index].begin = first_child;
+    nodes[node_index].count = 0;
+
+    build_node(index, first_child + 0, begin, middle);
+    build_node(index, first_child + 1, middle, end);
+}
+
+
+void Spatial_Index::build(const List<Widget*>& widgets) {
+    this->clear();
+
+    auto count = (Uint32)widgets.size();
+    if(count == 0) {
+        return;
+    }
+
+    this->items.reserve(count);
+    for(Uint32 i = 0; i < count; i += 1) {
+        auto widget = widgets[i];
+        this->items.push_back({ widget->position, widget->position + widget->size, i });
+    }
+
+    this->nodes.push_back({});
+    build_node(this, 0, 0, count);
+}
+
+
+void Spatial_Index::clear() {
+    this->nodes.clear();
+    this->items.clear();
+}
+
+
+void Spatial_Index::query(V2f point, List<Uint32>* result) const {
+    if(this->nodes.empty()) {
+        return;
+    }
+
+    // Median splits keep the depth at log2(count).
+    Uint32 stack[64];
+    auto stack_size = Uint(0);
+    stack[stack_size++] = 0;
+
+    while(stack_size > 0) {
+        auto& node = this->nodes[stack[--stack_size]];
+
+        if((point >= node.min && point < node.max) == false) {
+            continue;
+        }
+
+        if(node.count > 0) {
+            for(auto i = node.begin; i < node.begin + node.count; i += 1) {
+                auto& item = this->items[i];
+                if(point >= item.min && point < item.max) {
+                    result->push_back(item.index);
+                }
+            }
+        }
+        else {
+            stack[stack_size++] = node.begin + 0;
+            stack[stack_size++] = node.begin + 1;
+        }
+    }
+}
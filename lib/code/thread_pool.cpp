@@ -0,0 +1,86 @@
+#include <cpp-gui/thread_pool.hpp>
+
+
+void Thread_Pool::create(Uint thread_count) {
+    assert(this->workers.empty());
+    this->quit = false;
+
+    for(Uint i = 1; i < thread_count; i += 1) {
+        this->workers.push_back(std::thread([this]() {
+            auto seen_generation = Uint64(0);
+
+            while(true) {
+                {
+                    auto lock = std::unique_lock<std::mutex>(this->mutex);
+                    this->wake.wait(lock, [&]() {
+                        return this->quit || this->generation != seen_generation;
+                    });
+
+                    if(this->quit) {
+                        return;
+                    }
+                    seen_generation = this->generation;
+                }
+
+                this->work();
+
+                auto lock = std::unique_lock<std::mutex>(this->mutex);
+                this->active_count -= 1;
+                if(this->active_count == 0) {
+                    this->done.notify_all();
+                }
+            }
+        }));
+    }
+}
+
+void Thread_Pool::destroy() {
+    {
+        auto lock = std::unique_lock<std::mutex>(this->mutex);
+        this->quit = true;
+    }
+    this->wake.notify_all();
+
+    for(auto& worker : this->workers) {
+        worker.join();
+    }
+    this->workers.clear();
+}
+
+
+void Thread_Pool::run(Uint job_count, Function_Ref<void(Uint index)> job) {
+    if(this->workers.empty() || job_count <= 1) {
+        for(Uint i = 0; i < job_count; i += 1) {
+            job(i);
+        }
+        return;
+    }
+
+    {
+        auto lock = std::unique_lock<std::mutex>(this->mutex);
+        this->job          = &job;
+        this->job_count    = job_count;
+        this->next_job     = 0;
+        this->active_count = this->workers.size();
+        this->generation  += 1;
+    }
+    this->wake.notify_all();
+
+    this->work();
+
+    // Every worker takes part in every batch, so the batch state stays valid
+    // until they're all done.
+    auto lock = std::unique_lock<std::mutex>(this->mutex);
+    this->done.wait(lock, [&]() { return this->active_count == 0; });
+    this->job = nullptr;
+}
+
+void Thread_Pool::work() {
+    while(true) {
+        auto index = this->next_job.fetch_add(1);
+        if(index >= this->job_count) {
+            break;
+        }
+        (*this->job)(index);
+    }
+}
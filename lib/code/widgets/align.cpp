@@ -9,10 +9,12 @@ Widget* Align_Def::on_get_widget(Gui* gui) {
 
 
 void Align_Widget::match(const Align_Def& def) {
-    this->child       = this->reconcile(this->child, def.child);
-    this->align_point = def.align_point;
+    this->child = this->reconcile(this->child, def.child);
 
-    this->mark_for_layout();
+    if(this->align_point != def.align_point) {
+        this->align_point = def.align_point;
+        this->mark_for_layout();
+    }
 }
 
 Bool Align_Widget::on_try_match(Def* def) {
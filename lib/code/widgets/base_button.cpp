@@ -1,6 +1,5 @@
 #include <cpp-gui/core/gui.hpp>
 #include <cpp-gui/widgets/base_button.hpp>
-#include <cpp-gui/win32.hpp>
 
 
 Widget* Base_Button_Def::on_get_widget(Gui* gui) {
@@ -41,11 +40,11 @@ inline void maybe_send_press_end(Base_Button_Widget* button, Bool pressed_before
 void Base_Button_Widget::on_key_down(Win32_Virtual_Key key) {
     auto pressed_before = this->pressed();
 
-    if(key == VK_RETURN) {
+    if(key == virtual_key_return) {
         this->keyboard_pressing = true;
         maybe_send_press_begin(this, pressed_before);
     }
-    else if(key == VK_ESCAPE) {
+    else if(key == virtual_key_escape) {
         this->keyboard_pressing = false;
         this->mouse_pressing    = false;
         maybe_send_press_end(this, pressed_before);
@@ -53,7 +52,7 @@ void Base_Button_Widget::on_key_down(Win32_Virtual_Key key) {
 }
 
 void Base_Button_Widget::on_key_up(Win32_Virtual_Key key) {
-    if(key == VK_RETURN) {
+    if(key == virtual_key_return) {
         auto pressed_before = this->pressed();
         this->keyboard_pressing = false;
 
@@ -1,10 +1,12 @@
+#include <algorithm>
+
 #include <cpp-gui/core/gui.hpp>
 #include <cpp-gui/widgets/multi_child.hpp>
 
 
 Multi_Child_Def::~Multi_Child_Def() {
     for(auto child : this->children) {
-        delete child;
+        delete_def(child);
     }
     this->children.clear();
 }
@@ -23,8 +25,22 @@ Multi_Child_Widget::~Multi_Child_Widget() {
 
 
 void Multi_Child_Widget::match(const Multi_Child_Def& def) {
-    this->children = this->reconcile_list(this->children, def.children);
-    this->mark_for_layout();
+    this->children = this->reconcile_list(
+        this->children, def.children,
+        New_Child_Action::become_parent, &this->edits
+    );
+
+    // Children that changed mark themselves for layout.
+    if(this->edits.empty() == false) {
+        this->spatial_index_valid = false;
+        this->mark_for_layout();
+    }
+
+    this->use_spatial_index = def.use_spatial_index;
+    if(this->use_spatial_index == false) {
+        this->spatial_index.clear();
+        this->spatial_index_valid = false;
+    }
 }
 
 Bool Multi_Child_Widget::on_try_match(Def* def) {
@@ -32,15 +48,41 @@ Bool Multi_Child_Widget::on_try_match(Def* def) {
 }
 
 
-void Multi_Child_Widget::on_paint(ID2D1RenderTarget* target) {
+void Multi_Child_Widget::on_paint(Display_List* list) {
     for(auto child : this->children) {
-        child->paint(target);
+        child->paint(list);
     }
 }
 
 
-Bool Multi_Child_Widget::visit_children_for_hit_testing(std::function<Bool(Widget* child)> visitor, V2f point) {
-    UNUSED(point);
+Bool Multi_Child_Widget::visit_children_for_hit_testing(Function_Ref<Bool(Widget* child)> visitor, V2f point) {
+    if(this->use_spatial_index) {
+        auto is_outdated =
+               this->spatial_index_valid == false
+            || this->spatial_index_version != this->layout_version
+            || this->spatial_index.items.size() != this->children.size();
+
+        if(is_outdated) {
+            this->spatial_index.build(this->children);
+            this->spatial_index_version = this->layout_version;
+            this->spatial_index_valid   = true;
+        }
+
+        auto& hits = this->spatial_index_hits;
+        hits.clear();
+        this->spatial_index.query(point, &hits);
+
+        // Later children are in front.
+        std::sort(hits.begin(), hits.end(), [](Uint32 a, Uint32 b) { return a > b; });
+
+        for(auto index : hits) {
+            if(visitor(this->children[index])) {
+                return true;
+            }
+        }
+
+        return false;
+    }
 
     for(auto it = this->children.rbegin(); it != this->children.rend(); ++it) {
         if(visitor(*it)) {
@@ -10,9 +10,12 @@ Widget* Padding_Def::on_get_widget(Gui* gui) {
 
 void Padding_Widget::match(const Padding_Def& def) {
     this->child = this->reconcile(this->child, def.child);
-    this->pad_min = def.pad_min;
-    this->pad_max = def.pad_max;
-    this->mark_for_layout();
+
+    if(this->pad_min != def.pad_min || this->pad_max != def.pad_max) {
+        this->pad_min = def.pad_min;
+        this->pad_max = def.pad_max;
+        this->mark_for_layout();
+    }
 }
 
 Bool Padding_Widget::on_try_match(Def* def) {
@@ -9,7 +9,7 @@ Widget* Rounded_Def::on_get_widget(Gui* gui) {
 
 
 Float32 Rounded_Widget::get_corner_radius(Widget* widget) {
-    auto rounded = dynamic_cast<Rounded_Widget*>(widget);
+    auto rounded = fast_cast<Rounded_Widget>(widget);
     if(rounded != nullptr) { return rounded->corner_radius; }
     else                   { return 0.0f;                   }
 }
@@ -1,16 +1,18 @@
 #include <cpp-gui/widgets/shadow.hpp>
 #include <cpp-gui/widgets/rounded.hpp>
 #include <cpp-gui/core/gui.hpp>
-#include <cpp-gui/d2d.hpp>
-
-#include <d2d1_1.h>
-#include <d2d1effects.h>
 
 
 V2f Shadow_Fields::get_effective_size(V2f base_size) {
     return this->shadow_scale*base_size + this->shadow_size_delta;
 }
 
+Paint_Bounds Shadow_Fields::get_shadow_rect(V2f base_size) {
+    auto effective_size   = this->get_effective_size(base_size);
+    auto effective_offset = this->shadow_offset - 0.5f*(effective_size - base_size);
+    return Paint_Bounds { effective_offset, effective_offset + effective_size };
+}
+
 
 
 Widget* Shadow_Def::on_get_widget(Gui* gui) {
@@ -29,12 +31,13 @@ Bool Shadow_Widget::on_try_match(Def* def) {
 }
 
 
-void Shadow_Widget::on_paint(ID2D1RenderTarget* target) {
+void Shadow_Widget::on_paint(Display_List* list) {
     if(this->shadow_color.a == 0.0f) {
         return;
     }
 
-    auto effective_size = this->get_effective_size(this->size);
+    auto rect = this->get_shadow_rect(this->size);
+    auto effective_size = rect.max - rect.min;
 
     auto corner_radius = this->shadow_corner_radius;
     if(corner_radius < 0.0f) {
@@ -44,59 +47,25 @@ void Shadow_Widget::on_paint(ID2D1RenderTarget* target) {
         corner_radius = Rounded_Widget::get_effective_corner_radius(corner_radius, effective_size);
     }
 
-    auto hr = HRESULT();
-
-    // create off-screen buffer.
-    auto buffer = (ID2D1BitmapRenderTarget*)nullptr;
-    hr = target->CreateCompatibleRenderTarget(
-        to_d2d_sizef(effective_size), &buffer
+    list->blurred_rounded_rect(
+        rect.min, rect.max,
+        corner_radius, this->shadow_blur_radius,
+        this->shadow_color
     );
-    if(!SUCCEEDED(hr)) { return; }
-    defer { buffer->Release(); };
-
-    // draw rounded rectangle into buffer.
-    buffer->BeginDraw();
-    {
-        buffer->Clear({ 0, 0, 0, 0 });
-
-        auto brush = (ID2D1SolidColorBrush*)nullptr;
-        hr = buffer->CreateSolidColorBrush(to_d2d_colorf(this->shadow_color), &brush);
-        if(!SUCCEEDED(hr)) { return; }
-        defer { brush->Release(); };
-
-        auto rect = D2D1::RectF(0, 0, effective_size.x, effective_size.y);
-        buffer->FillRoundedRectangle(
-            D2D1::RoundedRect(rect, corner_radius, corner_radius),
-            brush
-        );
-    }
-    buffer->EndDraw();
-
-    // get buffer's bitmap.
-    auto bitmap = (ID2D1Bitmap*)nullptr;
-    hr = buffer->GetBitmap(&bitmap);
-    if(!SUCCEEDED(hr)) { return; }
-    defer { bitmap->Release(); };
-
-    // get device context.
-    auto context = (ID2D1DeviceContext*)nullptr;
-    hr = target->QueryInterface(&context);
-    if(!SUCCEEDED(hr)) { return; }
-    defer { context->Release(); };
-
-    // create blur.
-    auto blur = (ID2D1Effect*)nullptr;
-    hr = context->CreateEffect(CLSID_D2D1GaussianBlur, &blur);
-    if(!SUCCEEDED(hr)) { return; }
-    defer { blur->Release(); };
-
-    // configure blur.
-    blur->SetInput(0, bitmap);
-    hr = blur->SetValue(D2D1_GAUSSIANBLUR_PROP_STANDARD_DEVIATION, this->shadow_blur_radius/3.0f);
-    if(!SUCCEEDED(hr)) { return; }
-
-    // draw blur.
-    auto effective_offset = this->shadow_offset - 0.5f*(effective_size - this->size);
-    context->DrawImage(blur, to_d2d_point2f(effective_offset));
 }
 
+Paint_Bounds Shadow_Widget::get_paint_bounds() {
+    auto bounds = Widget::get_paint_bounds();
+    if(this->shadow_color.a == 0.0f) {
+        return bounds;
+    }
+
+    // The blur extends up to the (rounded up) blur radius. See Shadow_Cache.
+    auto rect    = this->get_shadow_rect(this->size);
+    auto padding = V2f(ceilf(max(this->shadow_blur_radius, 0.0f)));
+
+    return Paint_Bounds {
+        ::min(bounds.min, rect.min - padding),
+        ::max(bounds.max, rect.max + padding),
+    };
+}
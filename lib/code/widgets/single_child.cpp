@@ -3,7 +3,8 @@
 
 
 Single_Child_Def::~Single_Child_Def() {
-    safe_delete(&this->child);
+    delete_def(this->child);
+    this->child = nullptr;
 }
 
 Widget* Single_Child_Def::on_get_widget(Gui* gui) {
@@ -19,8 +20,9 @@ Single_Child_Widget::~Single_Child_Widget() {
 
 
 void Single_Child_Widget::match(const Single_Child_Def& def) {
+    // Reconcile marks this widget for layout if the child is replaced. A
+    // matched child marks itself if it changed.
     this->child = this->reconcile(this->child, def.child);
-    this->mark_for_layout();
 }
 
 Bool Single_Child_Widget::on_try_match(Def* def) {
@@ -40,14 +42,14 @@ void Single_Child_Widget::on_layout(Box_Constraints constraints) {
 }
 
 
-void Single_Child_Widget::on_paint(ID2D1RenderTarget* target) {
+void Single_Child_Widget::on_paint(Display_List* list) {
     if(this->child != nullptr) {
-        this->child->paint(target);
+        this->child->paint(list);
     }
 }
 
 
-Bool Single_Child_Widget::visit_children_for_hit_testing(std::function<Bool(Widget* child)> visitor, V2f point) {
+Bool Single_Child_Widget::visit_children_for_hit_testing(Function_Ref<Bool(Widget* child)> visitor, V2f point) {
     UNUSED(point);
     return this->child != nullptr && visitor(this->child);
 }
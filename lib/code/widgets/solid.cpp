@@ -1,7 +1,6 @@
 #include <cpp-gui/widgets/solid.hpp>
 #include <cpp-gui/widgets/rounded.hpp>
 #include <cpp-gui/core/gui.hpp>
-#include <cpp-gui/d2d.hpp>
 
 
 Widget* Solid_Def::on_get_widget(Gui* gui) {
@@ -21,31 +20,10 @@ Bool Solid_Widget::on_try_match(Def* def) {
 }
 
 
-void Solid_Widget::on_paint(ID2D1RenderTarget* target) {
+void Solid_Widget::on_paint(Display_List* list) {
     auto radius = Rounded_Widget::get_effective_corner_radius(this);
 
-    if(this->fill_color.a > 0.0f) {
-        auto brush = (ID2D1SolidColorBrush*)nullptr;
-        auto hr = target->CreateSolidColorBrush(to_d2d_colorf(this->fill_color), &brush);
-        if(SUCCEEDED(hr)) {
-            target->FillRoundedRectangle(
-                D2D1::RoundedRect(D2D1::RectF(0, 0, this->size.x, this->size.y), radius, radius),
-                brush
-            );
-            brush->Release();
-        }
-    }
-
-    if(this->stroke_color.a > 0.0f) {
-        auto brush = (ID2D1SolidColorBrush*)nullptr;
-        auto hr = target->CreateSolidColorBrush(to_d2d_colorf(this->stroke_color), &brush);
-        if(SUCCEEDED(hr)) {
-            target->DrawRoundedRectangle(
-                D2D1::RoundedRect(D2D1::RectF(0.5f, 0.5f, this->size.x - 0.5f, this->size.y - 0.5f), radius, radius),
-                brush
-            );
-            brush->Release();
-        }
+    if(this->fill_color.a > 0.0f || this->stroke_color.a > 0.0f) {
+        list->solid_rounded_rect(V2f { 0, 0 }, this->size, radius, this->fill_color, this->stroke_color);
     }
 }
-
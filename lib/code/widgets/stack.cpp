@@ -0,0 +1,129 @@
+#include <algorithm>
+
+#include <cpp-gui/core/gui.hpp>
+#include <cpp-gui/widgets/stack.hpp>
+
+
+Widget* Stack_Def::on_get_widget(Gui* gui) {
+    return gui->create_widget_and_match<Stack_Widget>(*this);
+}
+
+
+
+void Stack_Widget::match(const Stack_Def& def) {
+    Multi_Child_Widget::match(def);
+
+    auto changed =
+           this->axis        != def.axis
+        || this->direction   != def.direction
+        || this->cross_align != def.cross_align;
+
+    if(changed) {
+        this->axis        = def.axis;
+        this->direction   = def.direction;
+        this->cross_align = def.cross_align;
+        this->mark_for_layout();
+    }
+}
+
+Bool Stack_Widget::on_try_match(Def* def) {
+    return try_match_t<Stack_Def>(this, def);
+}
+
+
+void Stack_Widget::on_layout(Box_Constraints constraints) {
+    auto main  = Uint(this->axis);
+    auto cross = Uint(get_cross_axis(this->axis));
+
+    auto& offsets = this->child_offsets;
+    offsets.clear();
+    offsets.reserve(this->children.size() + 1);
+
+    // todo: constraints.
+    auto cursor     = 0.0f;
+    auto cross_size = 0.0f;
+    for(auto child : this->children) {
+        child->layout(constraints);
+
+        offsets.push_back(cursor);
+        cursor    += child->size[main];
+        cross_size = max(cross_size, child->size[cross]);
+    }
+    offsets.push_back(cursor);
+
+    this->size[main]  = cursor;
+    this->size[cross] = cross_size;
+
+    for(Uint i = 0; i < this->children.size(); i += 1) {
+        auto child = this->children[i];
+
+        auto position = V2f();
+        position[main] = (this->direction == Direction::min)
+            ? offsets[i]
+            : cursor - offsets[i + 1];
+        position[cross] = round(this->cross_align * (cross_size - child->size[cross]));
+
+        child->position = position;
+    }
+}
+
+
+Range<Uint> Stack_Widget::get_children_in_range(Float32 range_min, Float32 range_max) {
+    auto& offsets = this->child_offsets;
+    if(offsets.size() != this->children.size() + 1) {
+        // Not laid out since the children changed.
+        return Range<Uint> { 0, this->children.size() };
+    }
+
+    // Convert to offsets from the first child's edge.
+    if(this->direction == Direction::max) {
+        auto total = offsets.back();
+        auto old_min = range_min;
+        range_min = total - range_max;
+        range_max = total - old_min;
+    }
+
+    // Child i overlaps if offsets[i] < range_max and offsets[i + 1] > range_min.
+    auto first = offsets.begin();
+    auto begin = std::upper_bound(first + 1, offsets.end(), range_min) - (first + 1);
+    auto end   = std::lower_bound(first, offsets.end() - 1, range_max) - first;
+
+    return Range<Uint> { Uint(begin), max(Uint(begin), Uint(end)) };
+}
+
+Range<Uint> Stack_Widget::get_children_to_replay(Paint_Bounds visible) {
+    auto main = Uint(this->axis);
+    return this->get_children_in_range(visible.min[main], visible.max[main]);
+}
+
+
+
+Bool Stack_Widget::visit_children_for_hit_testing(Function_Ref<Bool(Widget* child)> visitor, V2f point) {
+    auto& offsets = this->child_offsets;
+    if(offsets.size() != this->children.size() + 1) {
+        // Not laid out since the children changed.
+        return Multi_Child_Widget::visit_children_for_hit_testing(visitor, point);
+    }
+
+    // Children don't overlap along the axis -> at most one candidate, found
+    // by binary search. The visitor does the exact test.
+    //  - min: child i covers [offsets[i], offsets[i + 1]).
+    //  - max: child i covers (offsets[i], offsets[i + 1]] after converting
+    //    the point to an offset from the first child's edge.
+    auto t = point[Uint(this->axis)];
+    auto first = offsets.begin();
+
+    auto index = Sint(0);
+    if(this->direction == Direction::min) {
+        index = (std::upper_bound(first, offsets.end(), t) - first) - 1;
+    }
+    else {
+        index = (std::lower_bound(first, offsets.end(), offsets.back() - t) - first) - 1;
+    }
+
+    if(index < 0 || index >= Sint(this->children.size())) {
+        return false;
+    }
+
+    return visitor(this->children[index]);
+}
@@ -19,11 +19,9 @@ void Text_Widget::match(const Text_Def& def) {
     this->layout.destroy();
     this->layout.create(def.font_face, def.size, def.string);
 
-    this->color      = def.color;
-    this->size       = this->layout.size;
-    this->baseline.y = round(def.font_face->ascent(def.size));
-    // mark layout as changed.
+    this->color = def.color;
 
+    this->mark_for_layout();
     this->mark_for_paint();
 }
 
@@ -32,10 +30,22 @@ Bool Text_Widget::on_try_match(Def* base_def) {
 }
 
 
-void Text_Widget::on_paint(ID2D1RenderTarget* target) {
+void Text_Widget::on_layout(Box_Constraints constraints) {
+    UNUSED(constraints);
+
+    this->size = this->layout.size;
+
+    // ensure layout has text.
+    if(this->layout.font_face != nullptr) {
+        this->baseline.y = round(this->layout.font_face->ascent(this->layout.run.fontEmSize));
+    }
+}
+
+
+void Text_Widget::on_paint(Display_List* list) {
     // ensure layout has text.
     if(this->layout.font_face != nullptr) {
-        this->layout.paint(target, this->color);
+        list->glyph_run(&this->layout, V2f { 0, 0 }, this->color);
     }
 }
 
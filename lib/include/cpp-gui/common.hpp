@@ -1,7 +1,11 @@
 #pragma once
 
 
+#include <cstddef>
 #include <functional>
+#include <limits>
+#include <type_traits>
+#include <typeinfo>
 using Void_Callback = std::function<void(void)>;
 
 
@@ -9,9 +13,89 @@ using Void_Callback = std::function<void(void)>;
 #include <cpp-common/math.hpp>
 
 
+// Non-owning reference to a callable.
+//  - Doesn't allocate, unlike std::function.
+//  - The callable must outlive the reference. Use it for parameters, not for
+//    storing callbacks.
+template <typename Signature>
+struct Function_Ref;
+
+template <typename R, typename... Args>
+struct Function_Ref<R(Args...)> {
+    void* object;
+    R (*invoke)(void* object, Args... args);
+
+    template <typename F,
+        typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Function_Ref>::value>>
+    Function_Ref(F&& f)
+        : object((void*)&f),
+          invoke([](void* object, Args... args) -> R {
+              return (*(std::remove_reference_t<F>*)object)(std::forward<Args>(args)...);
+          })
+    {}
+
+    R operator()(Args... args) const {
+        return this->invoke(this->object, std::forward<Args>(args)...);
+    }
+};
+
+
+// Cached dynamic_cast.
+//  - Defs and widgets derive from their bases virtually, so casts down or
+//    across the hierarchy can't be static_casts. dynamic_cast finds the
+//    `To` subobject by searching the class hierarchy, on every call.
+//  - The subobject's offset from the complete object only depends on the
+//    object's dynamic type. fast_cast caches it (or its absence) per
+//    From/To pair, for the last few dynamic types (by type_info address).
+//  - A hit is a typeid and a dynamic_cast<void*> (both read the vtable),
+//    a compare and an add.
+//  - Not a type id range check: Classes with several bases (eg:
+//    Simple_Button_Widget) are in several subtrees, which one range per
+//    class can't represent. And an id check alone doesn't find the
+//    subobject.
+//  - The caches are thread_local, so fast_cast is thread safe. (Each thread
+//    fills its own.)
+template <typename To, typename From>
+To* fast_cast(From* from) {
+    static_assert(std::is_polymorphic<From>::value, "fast_cast needs a polymorphic type.");
+
+    struct Entry {
+        const std::type_info* type;
+        std::ptrdiff_t        offset;
+    };
+
+    static const auto not_a_to = std::numeric_limits<std::ptrdiff_t>::min();
+    thread_local Entry cache[8];
+
+    if(from == nullptr) {
+        return nullptr;
+    }
+
+    auto type = &typeid(*from);
+    auto top  = (Uint8*)dynamic_cast<void*>(from);
+
+    auto& entry = cache[((Uint)type >> 3) & 7];
+    if(entry.type != type) {
+        auto to = dynamic_cast<To*>(from);
+        entry.type   = type;
+        entry.offset = (to != nullptr) ? (Uint8*)to - top : not_a_to;
+    }
+
+    if(entry.offset == not_a_to) {
+        return nullptr;
+    }
+    return (To*)(top + entry.offset);
+}
+
+
 using Win32_Virtual_Key = Uint8;
 using Ascii_Char = Uint8;
 
+// Keys the library handles. Same values as Win32's VK_* codes, so portable
+// code doesn't need Windows.h.
+const Win32_Virtual_Key virtual_key_return = 0x0D;
+const Win32_Virtual_Key virtual_key_escape = 0x1B;
+
 
 
 enum class Axis : Uint8 { x = 0, y = 1, };
@@ -49,6 +133,14 @@ struct Box_Constraints {
     }
 };
 
+inline Bool operator==(const Box_Constraints& a, const Box_Constraints& b) {
+    return a.min == b.min && a.max == b.max;
+}
+
+inline Bool operator!=(const Box_Constraints& a, const Box_Constraints& b) {
+    return !(a == b);
+}
+
 
 
 enum Mouse_Button : Uint8 {
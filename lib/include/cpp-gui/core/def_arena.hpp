@@ -0,0 +1,50 @@
+#pragma once
+
+#include <new>
+#include <utility>
+
+#include <cpp-gui/common.hpp>
+
+
+// Bump allocator for Def trees.
+//  - `create` constructs a def in the arena and sets its `in_arena` flag.
+//    Defs don't delete children that are in an arena.
+//  - `reset` runs the destructors (last created first) and reuses the
+//    memory. Gui resets its arena after set_root.
+//  - Arena defs may reference heap defs, but not the other way around: the
+//    heap def's destructor would look at its children after the reset.
+struct Def_Arena {
+    struct Block {
+        Uint8* memory;
+        Uint   size;
+    };
+
+    struct Destructor {
+        void* object;
+        void (*destroy)(void* object);
+    };
+
+    List<Block>      blocks;
+    Uint             cursor = 0; // in the last block.
+    List<Destructor> destructors;
+
+    Uint min_block_size = 64*1024;
+
+
+    void* allocate(Uint size, Uint align);
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        auto object = new(this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        object->in_arena = true;
+
+        auto destroy = [](void* object) { ((T*)object)->~T(); };
+        this->destructors.push_back({ object, destroy });
+
+        return object;
+    }
+
+    void reset();
+    void destroy();
+};
+
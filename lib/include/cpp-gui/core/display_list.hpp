@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cmath>
+
+#include <cpp-gui/common.hpp>
+
+
+struct Widget;
+struct Text_Layout;
+
+
+/* Display lists:
+    - Widgets record their paint commands into a display list instead of
+      drawing directly.
+    - The list is kept until the widget is marked for paint (or laid out), so
+      painting an unchanged widget is a walk over its recorded commands.
+    - Children are recorded as references. Their commands live in their own
+      lists, so a child's change doesn't invalidate the parent's list.
+    - Commands are POD: A header followed by the payload, padded to 8 bytes.
+*/
+
+enum class Paint_Command_Type : Uint32 {
+    fill_rounded_rect,
+    stroke_rounded_rect,
+    solid_rounded_rect,
+    blurred_rounded_rect,
+    glyph_run,
+    push_transform,
+    pop_transform,
+    push_clip,
+    pop_clip,
+    child,
+};
+
+struct Paint_Command_Header {
+    Paint_Command_Type type;
+    Uint32             size; // including header and padding.
+};
+
+
+// fill_rounded_rect, stroke_rounded_rect.
+//  - Strokes are 1px wide and centered on the rect's edge.
+struct Paint_Rounded_Rect {
+    V2f     min;
+    V2f     max;
+    Float32 radius;
+    V4f     color;
+};
+
+// A fill with a 1px stroke, inside the rect's edge (like Solid_Widget).
+//  - The stroke is centered half a pixel inside the edge, with the same
+//    radius. Backends may paint both in one pass.
+struct Paint_Solid_Rounded_Rect {
+    V2f     min;
+    V2f     max;
+    Float32 radius;
+    V4f     fill_color;
+    V4f     stroke_color;
+};
+
+struct Paint_Blurred_Rounded_Rect {
+    V2f     min;
+    V2f     max;
+    Float32 corner_radius;
+    Float32 blur_radius;
+    V4f     color;
+};
+
+// The layout must outlive the display list. (Widgets that own text layouts
+// mark themselves for paint when they change the layout.)
+struct Paint_Glyph_Run {
+    const Text_Layout* layout;
+    V2f                position;
+    V4f                color;
+};
+
+// Maps p to x_axis*p.x + y_axis*p.y + offset.
+struct Paint_Transform {
+    V2f x_axis;
+    V2f y_axis;
+    V2f offset;
+
+    static Paint_Transform translation(V2f offset) {
+        return Paint_Transform { V2f { 1, 0 }, V2f { 0, 1 }, offset };
+    }
+
+    Bool is_translation() const {
+        return this->x_axis == V2f { 1, 0 } && this->y_axis == V2f { 0, 1 };
+    }
+};
+
+// Axis aligned rect. Used for culling.
+//  - Bounds touching at an edge intersect, so empty bounds aren't culled
+//    inside the visible area.
+struct Paint_Bounds {
+    V2f min;
+    V2f max;
+
+    Bool intersects(const Paint_Bounds& other) const {
+        return this->min <= other.max && other.min <= this->max;
+    }
+
+    Paint_Bounds intersect(const Paint_Bounds& other) const {
+        return Paint_Bounds { ::max(this->min, other.min), ::min(this->max, other.max) };
+    }
+
+    // Bounds of the transformed rect.
+    Paint_Bounds transformed(const Paint_Transform& transform) const {
+        auto center = 0.5f*(this->min + this->max);
+        auto extent = 0.5f*(this->max - this->min);
+
+        auto new_center = center.x*transform.x_axis + center.y*transform.y_axis + transform.offset;
+        auto new_extent =
+              extent.x*V2f { fabsf(transform.x_axis.x), fabsf(transform.x_axis.y) }
+            + extent.y*V2f { fabsf(transform.y_axis.x), fabsf(transform.y_axis.y) };
+
+        return Paint_Bounds { new_center - new_extent, new_center + new_extent };
+    }
+};
+
+struct Paint_Clip {
+    V2f min;
+    V2f max;
+};
+
+// Painted with the child's own display list at the child's position.
+struct Paint_Child {
+    Widget* widget;
+};
+
+
+
+struct Display_List {
+    List<Uint8> buffer;
+
+    // Keeps the buffer's memory.
+    void clear() { this->buffer.clear(); }
+    Bool empty() const { return this->buffer.empty(); }
+
+
+    void fill_rounded_rect(V2f min, V2f max, Float32 radius, V4f color);
+    void stroke_rounded_rect(V2f min, V2f max, Float32 radius, V4f color);
+    void solid_rounded_rect(V2f min, V2f max, Float32 radius, V4f fill_color, V4f stroke_color);
+
+    void fill_rect(V2f min, V2f max, V4f color) {
+        this->fill_rounded_rect(min, max, 0.0f, color);
+    }
+
+    void blurred_rounded_rect(V2f min, V2f max, Float32 corner_radius, Float32 blur_radius, V4f color);
+
+    void glyph_run(const Text_Layout* layout, V2f position, V4f color);
+
+    void push_transform(Paint_Transform transform);
+    void push_translation(V2f offset) { this->push_transform(Paint_Transform::translation(offset)); }
+    void pop_transform();
+
+    void push_clip(V2f min, V2f max);
+    void pop_clip();
+
+    // Use Widget::paint to record children.
+    void child(Widget* widget);
+
+
+    // Appends a command and returns its (uninitialized) payload.
+    template <typename T>
+    T* push(Paint_Command_Type type) {
+        auto payload_size = aligned_pointer(sizeof(T), 8);
+        auto size = sizeof(Paint_Command_Header) + payload_size;
+
+        auto offset = this->buffer.size();
+        this->buffer.resize(offset + size);
+
+        auto header = (Paint_Command_Header*)&this->buffer[offset];
+        header->type = type;
+        header->size = (Uint32)size;
+        return (T*)(header + 1);
+    }
+
+    void push_empty(Paint_Command_Type type);
+
+
+    // Iteration.
+    //  - Visits each command's header. The payload follows the header.
+    template <typename F>
+    void for_each(F f) const {
+        auto cursor = Uint(0);
+        while(cursor < this->buffer.size()) {
+            auto header = (const Paint_Command_Header*)&this->buffer[cursor];
+            f(header);
+            cursor += header->size;
+        }
+    }
+};
+
+template <typename T>
+const T* get_payload(const Paint_Command_Header* header) {
+    return (const T*)(header + 1);
+}
+
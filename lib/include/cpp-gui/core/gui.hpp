@@ -1,7 +1,17 @@
 #pragma once
 
+#include <new>
+#include <unordered_map>
+#include <typeinfo>
+
 #include <cpp-gui/common.hpp>
 #include <cpp-gui/core/widget.hpp>
+#include <cpp-gui/core/def_arena.hpp>
+#include <cpp-gui/core/widget_pool.hpp>
+#include <cpp-gui/scratch_table.hpp>
+
+
+struct Render_Backend;
 
 
 struct Gui {
@@ -12,7 +22,45 @@ struct Gui {
 
     void set_root(Def* def);
 
-    void render_frame(V2f size, ID2D1RenderTarget* target);
+    // Defs for the next set_root.
+    //  - Reset after set_root. Don't delete arena defs.
+    Def_Arena def_arena;
+
+    template <typename Some_Def, typename... Args>
+    Some_Def* create_def(Args&&... args) {
+        return this->def_arena.create<Some_Def>(std::forward<Args>(args)...);
+    }
+
+    // String keys.
+    //  - Equal strings get the same key. Ids are never reused.
+    std::unordered_map<String, Uint64> interned_keys;
+
+    Key intern_key(const String& string);
+
+
+    // Scratch tables for Widget::reconcile_list.
+    //  - One per nesting level: reconcile_list recurses through `match`.
+    //  - Kept between rebuilds. See Scratch_Table.
+    struct Reconcile_Scratch {
+        Scratch_Table<Widget*, Pointer_Hash>   widget_to_index;
+        Scratch_Table<Key,     std::hash<Key>> key_to_index;
+
+        // For edit scripts.
+        List<Uint32> old_indices; // of the new widgets.
+        List<Uint32> lis_tails;
+        List<Uint32> lis_previous;
+        List<Uint8>  is_stable;
+    };
+
+    List<Reconcile_Scratch*> reconcile_scratch;
+    Uint                     reconcile_depth = 0;
+
+    Reconcile_Scratch* push_reconcile_scratch();
+    void               pop_reconcile_scratch();
+
+    // Lays out and paints the damaged parts of the target.
+    //  - Returns the damage that was repainted (see `frame_damage`).
+    const List<Paint_Bounds>& render_frame(V2f size, Render_Backend* backend);
 
 
     Void_Callback request_frame_callback;
@@ -22,6 +70,118 @@ struct Gui {
 
 
 
+    // Layout stuff.
+
+    // Relayout boundaries that need layout. See Widget::is_relayout_boundary.
+    //  - Unordered. Widgets are removed by swapping in the last one.
+    List<Widget*> layout_queue;
+
+    // Incremented whenever a layout finishes (or queued widgets are dropped).
+    // Marks from the same epoch are still consistent. See
+    // Widget::mark_for_layout.
+    Uint64 layout_epoch = 1;
+
+    void queue_layout(Widget* boundary);
+    void unqueue_layout(Widget* boundary);
+    void flush_layout_queue();
+
+    // Bounded recursion.
+    //  - Layout and reconciliation are recursive (parents need their
+    //    children's sizes, matching recurses through the tree). They call
+    //    `recurse` for each level. Every `stack_segment_interval` levels, the
+    //    recursion continues on a fresh stack segment, so deep trees can't
+    //    overflow the thread's stack. Between switches, the recursion is
+    //    native and at most `stack_segment_interval` levels deep.
+    //  - Segments are reused. They are platform specific (see
+    //    stack_segments.cpp): On Win32, they're fibers and are only used if
+    //    the app made the thread a fiber. Without segments, the recursion
+    //    stays on the caller's stack.
+    struct Stack_Segment;
+
+    Uint                 recursion_depth        = 0;
+    Uint                 stack_segment_interval = 256;
+    List<Stack_Segment*> stack_segments;
+    Uint                 stack_segment_depth    = 0;
+
+    void recurse(Function_Ref<void()> function) {
+        this->recursion_depth += 1;
+        defer { this->recursion_depth -= 1; };
+
+        if(this->recursion_depth % this->stack_segment_interval == 0) {
+            this->run_on_stack_segment(function);
+        }
+        else {
+            function();
+        }
+    }
+
+    void run_on_stack_segment(Function_Ref<void()> function);
+    void destroy_stack_segments();
+
+
+
+    // Paint stuff.
+
+    // Paint a widget's display list (recording it first if needed) and the
+    // display lists of its children.
+    //  - Iterative: Children are replayed from an explicit stack.
+    //  - Culling: Widgets whose paint bounds don't intersect the visible area
+    //    are skipped with their subtrees. `visible` is in the target's
+    //    coordinates (before its transform). Clips narrow it.
+    //  - Children outside the range from get_children_to_replay are culled
+    //    without calling get_paint_bounds on them.
+    void replay(Widget* widget, Render_Backend* backend, Paint_Bounds visible);
+
+    struct Replay_Frame {
+        Widget*         widget;
+        Uint            cursor; // in the display list.
+        Paint_Transform transform;
+        Uint            transform_stack_size;
+        Paint_Bounds    visible;
+        Uint            clip_stack_size;
+        Range<Uint>     children;    // from get_children_to_replay.
+        Uint            child_index; // of the next child command.
+    };
+
+    // Scratch for replay.
+    List<Replay_Frame>    replay_stack;
+    List<Paint_Transform> replay_transform_stack;
+    List<Paint_Bounds>    replay_clip_stack;
+
+    // Stats. Reset by render_frame, summed over its replays.
+    Uint replayed_widget_count = 0;
+    Uint culled_widget_count   = 0;
+
+    // Damage.
+    //  - Areas of the target that need to be repainted, in the target's
+    //    coordinates (root coordinates, unless the target has a transform).
+    //  - Damaged widgets (marked for paint or laid out) contribute their
+    //    bounds from the last replay and their new bounds after layout.
+    //    Children are assumed to paint inside their parent's paint bounds,
+    //    so children that only moved are covered by their parent.
+    //  - Merged into at most `max_damage_rects` rects.
+    //  - render_frame clips to each damage rect, clears it to `clear_color`
+    //    and replays the visible widgets. Everything is damaged after
+    //    damage_all (eg: the target was recreated) or a target resize.
+    List<Paint_Bounds> damage;
+    List<Paint_Bounds> frame_damage; // repainted by the last render_frame.
+    Uint               max_damage_rects = 8;
+    Bool               damaged_all      = true;
+    V2f                damage_target_size = { 0.0f, 0.0f };
+    List<Widget*>      damaged_widgets;
+    V4f                clear_color = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    void add_damage(Paint_Bounds bounds);
+    void damage_all();
+    void damage_widget(Widget* widget);
+    void undamage_widget(Widget* widget);
+
+    // Moves the pending damage into `frame_damage`.
+    void update_damage(V2f target_size);
+    void paint_damage(Render_Backend* backend);
+
+
+
     // Keyboard stuff.
 
     // TODO: WM_SETFOCUS and WM_KILLFOCUS?
@@ -52,6 +212,19 @@ struct Gui {
         List<Widget*> hot_list;
         Widget*       focus_widget;
 
+        // Scratch buffers for update_mouse. Reused to avoid allocations.
+        List<Widget*> hit_list;
+        List<Widget*> next_hot_list;
+
+        // update_mouse calls from event handlers are queued until the
+        // outer call is done. See update_mouse.
+        Bool updating;
+        Bool update_pending;
+        Bool pending_move_events;
+
+        // See Widget::hot_stamp.
+        Uint64 hot_stamp;
+
         V2f  position;
         V2f  delta;
         Bool button_states[Mouse_Button::_count];
@@ -60,6 +233,18 @@ struct Gui {
 
     void update_mouse(Bool send_move_events = false);
 
+    // Scratch for Widget::hit_test.
+    struct Hit_Test_Frame {
+        Widget* widget;
+        V2f     point;
+        Uint    next_child; // in hit_test_children.
+        Uint    end_child;
+    };
+
+    List<Hit_Test_Frame> hit_test_stack;
+    List<Widget*>        hit_test_children;
+    Bool                 hit_testing = false;
+
     Widget* get_mouse_focus();
     Bool    set_mouse_focus(Widget* new_focus);
 
@@ -69,14 +254,71 @@ struct Gui {
 
 
 
+    // Widget memory.
+    //  - Indexed by get_widget_pool_index. Null for types that haven't been
+    //    created yet.
+    List<Widget_Pool*> widget_pools;
+
+    // False: create_widget uses new. (eg: to compare allocators.)
+    Bool use_widget_pools = true;
+
+    template <typename Some_Widget>
+    Widget_Pool* get_widget_pool() {
+        auto index = get_widget_pool_index<Some_Widget>();
+        if(index >= this->widget_pools.size()) {
+            this->widget_pools.resize(index + 1, nullptr);
+        }
+
+        auto& pool = this->widget_pools[index];
+        if(pool == nullptr) {
+            pool = new Widget_Pool();
+            pool->create(typeid(Some_Widget).name(), sizeof(Some_Widget), alignof(Some_Widget));
+        }
+
+        return pool;
+    }
+
     template <typename Some_Widget>
     Some_Widget* create_widget() {
-        auto widget = new Some_Widget();
+        auto widget = (Some_Widget*)nullptr;
+        if(this->use_widget_pools) {
+            auto pool = this->get_widget_pool<Some_Widget>();
+            widget = new(pool->allocate()) Some_Widget();
+            widget->pool = pool;
+        }
+        else {
+            widget = new Some_Widget();
+        }
+
         widget->gui = this;
         widget->on_create();
         return widget;
     }
 
+    // Destroys a widget created by create_widget (or with new).
+    void destroy_widget(Widget* widget);
+
+
+    // Deferred destruction.
+    //  - Widget::drop buries widgets: They are unlinked from the Gui right
+    //    away (focus, hot list, layout queue) and destroyed later.
+    //  - Destroying a buried widget buries its children, so large subtrees
+    //    are freed a few widgets at a time.
+    //  - render_frame frees buried widgets for up to `teardown_budget`
+    //    seconds and requests another frame if some are left. Apps can also
+    //    call free_graveyard when idle.
+    //  - `synchronous_teardown` destroys widgets immediately (eg: for tests).
+    List<Widget*> graveyard;
+    Float64       teardown_budget      = 0.002;
+    Bool          synchronous_teardown = false;
+    Bool          freeing_graveyard    = false;
+
+    void bury_widget(Widget* widget);
+    void add_to_graveyard(Widget* widget);
+
+    // Returns whether the graveyard is empty.
+    Bool free_graveyard(Float64 budget_seconds);
+
     template <typename Some_Widget, typename Some_Def>
     Some_Widget* create_widget_and_match(const Some_Def& def) {
         auto widget = this->create_widget<Some_Widget>();
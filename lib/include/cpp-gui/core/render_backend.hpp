@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cpp-gui/common.hpp>
+#include <cpp-gui/core/display_list.hpp>
+
+
+// What Gui::replay paints with.
+//  - Implementations: D2D_Backend (cpp-gui/d2d_backend.hpp) and CPU_Backend
+//    (cpp-gui/cpu_backend.hpp).
+//  - Coordinates are mapped to the target by the current transform. Replay
+//    only changes it when its linear part changes and offsets primitives
+//    otherwise, so backends may assume transforms rarely change.
+//  - Colors are straight (not premultiplied) alpha.
+struct Render_Backend {
+    virtual ~Render_Backend() {}
+
+    // Size of the target in its own coordinates.
+    virtual V2f get_size() = 0;
+
+    virtual Paint_Transform get_transform() = 0;
+    virtual void set_transform(const Paint_Transform& transform) = 0;
+
+    // Axis aligned clips.
+    //  - Transformed by the current transform when pushed.
+    //  - Aliased clips snap to whole pixels (eg: for damage rects).
+    virtual void push_clip(Paint_Bounds bounds, Bool aliased) = 0;
+    virtual void pop_clip() = 0;
+
+    // Sets the pixels inside the clip to `color` (no blending).
+    virtual void clear(V4f color) = 0;
+
+    virtual void fill_rounded_rect(const Paint_Rounded_Rect& rect) = 0;
+    virtual void stroke_rounded_rect(const Paint_Rounded_Rect& rect) = 0;
+
+    // Default: fill_rounded_rect, then stroke_rounded_rect.
+    virtual void solid_rounded_rect(const Paint_Solid_Rounded_Rect& rect) {
+        if(rect.fill_color.a > 0.0f) {
+            this->fill_rounded_rect(Paint_Rounded_Rect { rect.min, rect.max, rect.radius, rect.fill_color });
+        }
+
+        if(rect.stroke_color.a > 0.0f) {
+            this->stroke_rounded_rect(Paint_Rounded_Rect {
+                rect.min + V2f(0.5f), rect.max - V2f(0.5f), rect.radius, rect.stroke_color
+            });
+        }
+    }
+
+    virtual void blurred_rounded_rect(const Paint_Blurred_Rounded_Rect& shadow) = 0;
+    virtual void glyph_run(const Paint_Glyph_Run& run) = 0;
+
+    // Finishes the frame's painting. Called by Gui::render_frame.
+    //  - Default: Nothing.
+    virtual void flush() {}
+};
+
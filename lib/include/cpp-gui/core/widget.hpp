@@ -3,20 +3,84 @@
 // disable multiple inheritance dominance info.
 #pragma warning(disable: 4250)
 
+#include <typeinfo>
+
 #include <cpp-gui/common.hpp>
+#include <cpp-gui/core/display_list.hpp>
 
 
 struct Def;
-struct Key;
 struct Widget;
 struct Gui;
-struct ID2D1RenderTarget;
+struct Widget_Pool;
 
 
-struct Def {
-    Key* key = nullptr;
+// Keys identify a def's widget among its siblings across rebuilds.
+//  - Values: A type tag, a hash (computed once) and a 64 bit value.
+//  - Keys of different types are never equal.
+//  - String keys are interned by Gui::intern_key, so their value is an id.
+enum class Key_Type : Uint32 {
+    none,
+    uint,
+    pointer,
+    string,
+
+    // Custom key types start here.
+    user,
+};
+
+struct Key {
+    Key_Type type  = Key_Type::none;
+    Uint32   hash  = 0;
+    Uint64   value = 0;
+
+    static Key make(Key_Type type, Uint64 value);
+
+    static Key from_uint(Uint64 value) { return Key::make(Key_Type::uint, value); }
+    static Key from_pointer(const void* pointer) { return Key::make(Key_Type::pointer, (Uint64)(Uint)pointer); }
+
+    Bool is_none() const { return this->type == Key_Type::none; }
+
+    Bool operator==(const Key& other) const {
+        return this->type == other.type && this->value == other.value;
+    }
 
-    Def* with_key(Key* key);
+    Bool operator!=(const Key& other) const { return !(*this == other); }
+};
+
+inline Key Key::make(Key_Type type, Uint64 value) {
+    // splitmix64 finalizer.
+    auto x = value + 0x9E3779B97F4A7C15ull*(Uint64(type) + 1);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x =  x ^ (x >> 31);
+
+    auto key = Key {};
+    key.type  = type;
+    key.hash  = Uint32(x);
+    key.value = value;
+    return key;
+}
+
+
+
+struct Def {
+    Key key;
+
+    // Set by Def_Arena::create.
+    Bool in_arena = false;
+
+    // Memoization.
+    //  - A hash or version of everything the def (and its subtree) depends
+    //    on, supplied by the user. See combine_memo.
+    //  - If a widget was last matched against a def of the same type with the
+    //    same memo, reconciling skips the subtree. Layout and paint stay
+    //    valid.
+    Uint64 memo     = 0;
+    Bool   has_memo = false;
+
+    Def* with_key(Key key);
+    Def* with_memo(Uint64 memo);
     Widget* get_widget(Gui* gui);
 
 
@@ -28,6 +92,14 @@ struct Def {
     Bool used = false;
 };
 
+// Deletes a (child) def, unless it is in an arena.
+void delete_def(Def* def);
+
+// For computing memos from several values.
+inline Uint64 combine_memo(Uint64 memo, Uint64 value) {
+    return memo ^ (value + 0x9E3779B97F4A7C15ull + (memo << 6) + (memo >> 2));
+}
+
 struct Widget_Def : virtual Def {
     Widget* widget;
 
@@ -43,47 +115,104 @@ struct Widget_Def : virtual Def {
 
 
 
-struct Key {
-    virtual ~Key() {}
-    virtual Bool equal_to(const Key* other) = 0;
-    virtual Uint hash() = 0;
-};
-
-template <typename T>
-struct T_Key : virtual Key {
-    T value;
-
-    T_Key(const T& value) : value(value) {}
+// What reconcile_list did to a list, in terms of indices.
+//  - inserts: New indices of widgets that weren't in the old list.
+//  - removes: Old indices of widgets that were dropped (ascending).
+//  - moves:   Reused widgets that aren't part of the longest run of reused
+//             widgets that kept their relative order. Moving just these
+//             turns the old list into the new one.
+//  - Reused widgets that didn't move aren't mentioned.
+struct Reconcile_Edits {
+    struct Move {
+        Uint32 old_index;
+        Uint32 new_index;
+    };
 
-    virtual Bool equal_to(const Key* other) final override {
-        auto _other = dynamic_cast<const T_Key<T>*>(other);
-        if(_other == nullptr) {
-            return false;
-        }
+    List<Uint32> inserts;
+    List<Uint32> removes;
+    List<Move>   moves;
 
-        return this->value == _other->value;
+    void clear() {
+        this->inserts.clear();
+        this->removes.clear();
+        this->moves.clear();
     }
 
-    virtual Uint hash() final override {
-        return std::hash<T>()(this->value);
+    Bool empty() const {
+        return this->inserts.empty() && this->removes.empty() && this->moves.empty();
     }
 };
 
 
 
-
 struct Widget {
     Gui* gui;
 
+    // Where the widget's memory came from. Null if it was created with new.
+    Widget_Pool* pool = nullptr;
+
     Widget* owner;
     Widget* parent;
 
-    Key* key;
+    Key key;
+
+    // Memo of the last matched def. Null type if it had none.
+    Uint64                memo          = 0;
+    const std::type_info* memo_def_type = nullptr;
 
     V2f position;
     V2f size;
     V2f baseline;
 
+    // Layout cache.
+    //  - `needs_layout` is set by mark_for_layout on this widget and its
+    //    ancestors up to the nearest relayout boundary.
+    //    `layout_mark_epoch` is the Gui::layout_epoch of that mark.
+    //  - `layout_constraints` are the constraints of the last layout.
+    //  - Widget::layout skips on_layout if neither changed.
+    Bool            needs_layout = true;
+    Uint64          layout_mark_epoch = 0;
+    Bool            has_layout   = false;
+    Bool            in_layout_queue = false;
+    Uint            layout_queue_index = 0; // if in_layout_queue.
+    Box_Constraints layout_constraints;
+
+    // Incremented whenever on_layout runs. Caches derived from the layout
+    // (eg: of child positions) compare against it.
+    Uint32 layout_version = 0;
+
+    // Paint cache.
+    //  - `display_list` holds the commands recorded by on_paint.
+    //  - `needs_paint` is set by mark_for_paint and when the widget is laid
+    //    out. The list is recorded again before the next replay.
+    Display_List display_list;
+    Bool         needs_paint = true;
+
+    // Where the last replay put the widget, in the target's coordinates.
+    //  - Set even if the widget was culled by its bounds. Children skipped
+    //    by their parent's get_children_to_replay keep their old values,
+    //    like the descendants of culled widgets.
+    //  - `replay_bounds` include the children's overflow (see
+    //    child_paint_overflow).
+    //  - `replay_outer_transform` is the parent's transform at the child
+    //    command. Used to find the widget's new bounds after a layout.
+    //  - See Gui::damage_widget.
+    Bool            was_replayed = false;
+    Paint_Transform replay_outer_transform;
+    Paint_Bounds    replay_bounds;
+    Bool            is_damaged = false;
+    Uint            damaged_index = 0; // in Gui::damaged_widgets, if is_damaged.
+
+    // How far the children's paint bounds extend past their rects, at most.
+    // Grown by Gui::update_damage. See get_children_to_replay.
+    Float32 child_paint_overflow = 0.0f;
+
+    // Used by Gui::update_mouse to diff hot lists without allocating.
+    Uint64 hot_stamp = 0;
+
+    // In the Gui's graveyard. See Gui::bury_widget.
+    Bool is_buried = false;
+
     void become_parent(Widget* child);
     void become_owner(Widget* child);
     void transfer_ownership(Widget* child, Widget* new_owner);
@@ -91,6 +220,7 @@ struct Widget {
     void drop_maybe(Widget* child);
 
     Bool try_match(Def* def);
+    void set_memo(Def* def);
 
 
     enum class New_Child_Action {
@@ -106,17 +236,35 @@ struct Widget {
 
     // NOTE: The list of old widgets is modified by the call. It should not be
     //  used after the call.
+    //  - `edits` (optional) is cleared and receives the edit script.
     List<Widget*> reconcile_list(
         List<Widget*>& old_widgets, const List<Def*>& new_defs,
-        New_Child_Action new_child_action = New_Child_Action::become_parent
+        New_Child_Action new_child_action = New_Child_Action::become_parent,
+        Reconcile_Edits* edits = nullptr
     );
 
 
     void mark_for_layout();
     void layout(Box_Constraints constraints);
 
+    // Relayout boundary.
+    //  - Changes in this widget's subtree can't change its size, so its
+    //    parent doesn't need to be laid out again.
+    //  - True if the last layout had tight constraints or the widget is sized
+    //    by its parent.
+    //  - Dirty boundaries are laid out with their last constraints by
+    //    Gui::render_frame. If their size changes anyway (widgets that ignore
+    //    their constraints), the parent is marked for layout.
+    Bool is_relayout_boundary();
+
+    // Also damages the widget. See Gui::damage_widget.
     void mark_for_paint();
-    void paint(ID2D1RenderTarget* target);
+
+    // Record this widget into a parent's display list.
+    void paint(Display_List* list);
+
+    // Record the display list if the widget was marked for paint.
+    void update_display_list();
 
 
     // These return whether this widget had the keyboard focus before the call.
@@ -132,10 +280,11 @@ struct Widget {
 
 
     // Hit test.
-    //  - Returns a list of hit widgets in front-to-back order (potential
+    //  - Appends the hit widgets to `result` in front-to-back order (potential
     //    entries are this widget and any descendants).
     //  - `should_stop` can be used to implement blocking.
-    List<Widget*> hit_test(V2f point, std::function<Bool(Widget*)> should_stop);
+    //  - Doesn't allocate if `result` has enough capacity.
+    void hit_test(V2f point, Function_Ref<Bool(Widget*)> should_stop, List<Widget*>* result);
 
 
     V2f get_offset_from(Widget* ancestor) const;
@@ -164,9 +313,35 @@ struct Widget {
     //  - Call Widget::layout to lay out children. Not this procedure!
     virtual void on_layout(Box_Constraints constraints);
 
-    // Paint this widget and its children.
+    // Property: Sized by parent.
+    //  - Returns whether this widget's size only depends on its constraints.
+    //  - Such widgets are relayout boundaries.
+    //  - Default: False.
+    virtual Bool sized_by_parent();
+
+    // Record paint commands for this widget and its children.
     //  - Call Widget::paint to paint children. Not this procedure!
-    virtual void on_paint(ID2D1RenderTarget* target);
+    //  - The commands are cached. This is only called after the widget was
+    //    marked for paint or laid out.
+    virtual void on_paint(Display_List* list);
+
+    // Property: Paint bounds.
+    //  - Returns the rect (in local coordinates) that this widget and its
+    //    descendants paint into.
+    //  - Replay skips the subtree if the bounds are outside the visible area.
+    //  - Default: The widget's rect. Widgets that paint outside of it (eg:
+    //    shadows) or let their children overflow must return larger bounds.
+    virtual Paint_Bounds get_paint_bounds();
+
+    // Children to replay.
+    //  - Returns the range of child commands (by index among the child
+    //    commands in this widget's display list) that may intersect
+    //    `visible`. Replay skips the others without testing their bounds.
+    //  - `visible` is in local coordinates and already grown by
+    //    child_paint_overflow.
+    //  - For containers whose children are ordered in space (eg: stacks).
+    //  - Default: All children.
+    virtual Range<Uint> get_children_to_replay(Paint_Bounds visible);
 
 
     virtual void on_gain_keyboard_focus();
@@ -192,7 +367,7 @@ struct Widget {
     //    has no children, return false.
     //  - The system generally only calls this procedure if on_hit_test returned
     //    true for this widget.
-    virtual Bool visit_children_for_hit_testing(std::function<Bool(Widget* child)> visitor, V2f point);
+    virtual Bool visit_children_for_hit_testing(Function_Ref<Bool(Widget* child)> visitor, V2f point);
 
     // Property: Blocks mouse.
     //  - Returns whether this widget should currently block the mouse from
@@ -266,7 +441,7 @@ struct Widget {
 // Helper for implementing "try_match" if widget has "match".
 template <typename Some_Def, typename Some_Widget>
 Bool try_match_t(Some_Widget* widget, Def* base_def) {
-    auto def = dynamic_cast<Some_Def*>(base_def);
+    auto def = fast_cast<Some_Def>(base_def);
     if(def != nullptr) {
         widget->match(*def);
         return true;
@@ -280,22 +455,11 @@ Bool try_match_t(Some_Widget* widget, Def* base_def) {
 
 // Helper for using std::unordered_map with keys.
 
-struct Key_Pointer {
-    Key* key;
-
-    Key_Pointer(Key* key) : key(key) {}
-};
-
-inline Bool operator==(Key_Pointer left, Key_Pointer right) {
-    return left.key->equal_to(right.key);
-}
-
 namespace std {
     template <>
-    struct hash<Key_Pointer> {
-        std::size_t operator()(Key_Pointer key_pointer) const noexcept {
-            return key_pointer.key->hash();
+    struct hash<Key> {
+        std::size_t operator()(const Key& key) const noexcept {
+            return key.hash;
         }
     };
 }
-
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cpp-gui/common.hpp>
+
+
+// Slab allocator for the widgets of one type.
+//  - Gui::create_widget allocates from the pool of the widget's type,
+//    Gui::destroy_widget returns the memory to the pool's free list.
+//  - Slabs are kept until the pool is destroyed (with its Gui), so churning
+//    lists reuse the same memory.
+//  - Not thread safe. Widgets are created and destroyed on the Gui's thread.
+struct Widget_Pool {
+    const char* type_name;
+    Uint        object_size;
+    Uint        objects_per_slab;
+
+    List<void*> slabs;
+    void*       free_list;
+
+    // Statistics.
+    Uint   live_count;
+    Uint   peak_count;
+    Uint64 allocation_count;
+
+    void create(const char* type_name, Uint object_size, Uint object_align);
+    void destroy();
+
+    void* allocate();
+    void  free(void* object);
+
+    Uint get_slab_bytes() const { return this->slabs.size() * this->objects_per_slab * this->object_size; }
+    Uint get_live_bytes() const { return this->live_count * this->object_size; }
+};
+
+
+// Index of the widget type's pool in Gui::widget_pools.
+Uint allocate_widget_pool_index();
+
+template <typename Some_Widget>
+Uint get_widget_pool_index() {
+    static const Uint index = allocate_widget_pool_index();
+    return index;
+}
+
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cpp-gui/common.hpp>
+#include <cpp-gui/core/render_backend.hpp>
+#include <cpp-gui/thread_pool.hpp>
+#include <cpp-gui/rounded_rect_kernel.hpp>
+
+
+// Rasterizes into an RGBA8 framebuffer in memory.
+//  - Doesn't use Direct2D, so frames can be rendered headless (eg: tests,
+//    benchmarks, CI).
+//  - Pixels are premultiplied and stored as R, G, B, A bytes, rows top to
+//    bottom.
+//  - Rounded rects are anti-aliased with Rounded_Rect_Kernel (SSE2 or AVX2,
+//    picked at runtime). Spans inside the edges are filled and blended 4
+//    pixels at a time (SSE2, where available).
+//  - solid_rounded_rect paints the fill and the stroke in one pass.
+//  - Shadows are evaluated analytically with Shadow_Kernel.
+//  - Transforms: Translation and axis aligned scale. Shapes under other
+//    transforms are painted as their transformed bounds.
+//  - Clips snap to whole pixels.
+//  - Text needs a font rasterizer, so glyph runs are passed to `glyph_hook`
+//    with their position in pixels (the transform's linear part is
+//    ignored). Hooks composite glyph coverage with blend_mask. Without a
+//    hook, text isn't painted.
+//  - Tiled mode: Primitives are recorded and binned into `tile_size` tiles,
+//    which flush rasterizes in parallel on `thread_pool` (if set). Pixels
+//    are computed the same way as in immediate mode, so both produce the
+//    same bytes, for any thread count.
+struct CPU_Backend : Render_Backend {
+    struct Pixel_Rect {
+        Sint32 x0, y0;
+        Sint32 x1, y1; // exclusive.
+    };
+
+    // Rounded rect in pixel coordinates.
+    using Shape = Rounded_Rect_Kernel::Shape;
+
+    enum class Command_Type : Uint32 {
+        clear,
+        rounded_rect,
+        blur,
+        mask,
+    };
+
+    // A primitive with its transform and clip applied.
+    struct Command {
+        Command_Type type;
+        Uint32       color;  // premultiplied.
+        Pixel_Rect   bounds; // clipped.
+
+        // rounded_rect, blur.
+        Shape   shape;
+        Float32 blur_radius;
+
+        // rounded_rect: Painted on top of the fill (`color`, 0: none).
+        Shape   stroke_shape;
+        Uint32  stroke_color;
+        Float32 stroke_half_width;
+
+        // mask: Coverage in `mask_data`.
+        Sint32 mask_x;
+        Sint32 mask_y;
+        Uint   mask_offset;
+        Uint32 mask_stride;
+    };
+
+    Uint32       width  = 0;
+    Uint32       height = 0;
+    List<Uint32> pixels;
+
+    Paint_Transform  transform = Paint_Transform::translation(V2f { 0, 0 });
+    Pixel_Rect       clip      = {};
+    List<Pixel_Rect> clip_stack;
+
+    std::function<void(CPU_Backend* backend, const Paint_Glyph_Run& run)> glyph_hook;
+
+    Bool         tiled       = false;
+    Uint32       tile_size   = 64;
+    Thread_Pool* thread_pool = nullptr;
+
+    // Highest kernel level for rounded rects (eg: to compare levels).
+    Rounded_Rect_Kernel::Level kernel_level = Rounded_Rect_Kernel::Level::avx2;
+
+    // Tiled mode state. Kept between frames.
+    List<Command>      commands;
+    List<Uint8>        mask_data;
+    List<List<Uint32>> tile_commands; // indices, in order.
+    List<Uint64>       tile_pixel_counts;
+
+    // Statistics.
+    Uint64 pixel_count = 0; // covered pixels, including partial ones.
+
+
+    // Allocates a `width` by `height` framebuffer, cleared to transparent.
+    void create(Uint32 width, Uint32 height);
+    void destroy();
+
+    // Rasterizes a command (now, or when flushing in tiled mode).
+    void submit(const Command& command);
+
+    // Returns the number of pixels that were touched.
+    Uint64 execute(const Command& command, Pixel_Rect region);
+
+    // Pixels are only valid after flush in tiled mode.
+    Uint32 get_pixel(Uint32 x, Uint32 y) const {
+        return this->pixels[y*this->width + x];
+    }
+
+    // Blends `color` with per pixel coverage (0-255) at a pixel position.
+    //  - Clipped to the current clip.
+    void blend_mask(
+        Sint32 x, Sint32 y, Uint32 mask_width, Uint32 mask_height,
+        const Uint8* mask, Uint mask_stride, V4f color
+    );
+
+
+    virtual V2f get_size() override;
+
+    virtual Paint_Transform get_transform() override;
+    virtual void set_transform(const Paint_Transform& transform) override;
+
+    virtual void push_clip(Paint_Bounds bounds, Bool aliased) override;
+    virtual void pop_clip() override;
+
+    virtual void clear(V4f color) override;
+
+    virtual void fill_rounded_rect(const Paint_Rounded_Rect& rect) override;
+    virtual void stroke_rounded_rect(const Paint_Rounded_Rect& rect) override;
+    virtual void solid_rounded_rect(const Paint_Solid_Rounded_Rect& rect) override;
+    virtual void blurred_rounded_rect(const Paint_Blurred_Rounded_Rect& shadow) override;
+    virtual void glyph_run(const Paint_Glyph_Run& run) override;
+
+    virtual void flush() override;
+};
+
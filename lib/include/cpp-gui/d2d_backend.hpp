@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cpp-gui/common.hpp>
+#include <cpp-gui/core/render_backend.hpp>
+#include <cpp-gui/d2d_cache.hpp>
+
+
+struct ID2D1RenderTarget;
+
+
+// Paints to a Direct2D render target.
+//  - Brushes and shadow bitmaps are cached. They belong to the target, so
+//    call release_device_resources before the target is recreated.
+struct D2D_Backend : Render_Backend {
+    ID2D1RenderTarget* target = nullptr;
+
+    Brush_Cache  brush_cache;
+    Shadow_Cache shadow_cache;
+
+    void release_device_resources();
+
+
+    virtual V2f get_size() override;
+
+    virtual Paint_Transform get_transform() override;
+    virtual void set_transform(const Paint_Transform& transform) override;
+
+    virtual void push_clip(Paint_Bounds bounds, Bool aliased) override;
+    virtual void pop_clip() override;
+
+    virtual void clear(V4f color) override;
+
+    virtual void fill_rounded_rect(const Paint_Rounded_Rect& rect) override;
+    virtual void stroke_rounded_rect(const Paint_Rounded_Rect& rect) override;
+    virtual void blurred_rounded_rect(const Paint_Blurred_Rounded_Rect& shadow) override;
+    virtual void glyph_run(const Paint_Glyph_Run& run) override;
+};
+
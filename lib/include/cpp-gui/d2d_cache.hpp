@@ -0,0 +1,100 @@
+#pragma once
+
+#include <unordered_map>
+#include <list>
+
+#include <cpp-gui/common.hpp>
+
+
+struct ID2D1RenderTarget;
+struct ID2D1SolidColorBrush;
+struct ID2D1Bitmap;
+
+
+// Solid color brushes by color.
+//  - Colors are quantized to 8 bits per channel.
+//  - Brushes belong to a render target. The cache is emptied when it is used
+//    with a different target. Call `release` before recreating a target (the
+//    new one could have the same address).
+//  - Emptied when it holds `max_brushes` brushes (eg: animated colors).
+struct Brush_Cache {
+    ID2D1RenderTarget* target = nullptr;
+    std::unordered_map<Uint32, ID2D1SolidColorBrush*> brushes;
+
+    Uint max_brushes = 256;
+
+    // Statistics.
+    Uint64 hit_count  = 0;
+    Uint64 miss_count = 0;
+
+
+    // Returns nullptr if the brush could not be created.
+    ID2D1SolidColorBrush* get(ID2D1RenderTarget* target, V4f color);
+
+    void release();
+    void release_brushes();
+};
+
+
+
+// Blurred rounded rects (shadows) by shape, blur and color.
+//  - Entries are nine-patches: The rect is drawn at its minimum size along
+//    axes where the blurred edge is constant in the middle. Such axes are
+//    stretched when painting, so resizing reuses the bitmap.
+//  - Sizes are quantized to quarter pixels, colors to 8 bits per channel.
+//  - Least recently used entries are evicted once the bitmaps exceed
+//    `byte_budget`.
+//  - Bound to a render target like Brush_Cache.
+struct Shadow_Cache {
+    struct Key {
+        Uint32 size_x; // 0 if stretched.
+        Uint32 size_y; // 0 if stretched.
+        Uint32 corner_radius;
+        Uint32 blur_radius;
+        Uint32 color;
+
+        Bool operator==(const Key& other) const;
+    };
+
+    struct Key_Hash {
+        std::size_t operator()(const Key& key) const noexcept;
+    };
+
+    struct Entry {
+        ID2D1Bitmap* bitmap;
+
+        // Bitmap coordinates. The blur extends `padding` beyond the rect.
+        V2f     size;
+        Float32 padding;
+
+        // Nine-patch splits. The range between them is stretched.
+        V2f split_min;
+        V2f split_max;
+
+        Uint bytes;
+        std::list<Key>::iterator lru_position;
+    };
+
+    ID2D1RenderTarget* target = nullptr;
+    std::unordered_map<Key, Entry, Key_Hash> entries;
+    std::list<Key> lru; // most recently used first.
+
+    Uint byte_budget = 16*1024*1024;
+    Uint byte_count  = 0;
+
+    // Statistics.
+    Uint64 hit_count  = 0;
+    Uint64 miss_count = 0;
+
+
+    // Returns nullptr if the bitmap could not be created.
+    //  - The entry is valid until the next call.
+    const Entry* get(
+        ID2D1RenderTarget* target, V2f size,
+        Float32 corner_radius, Float32 blur_radius, V4f color
+    );
+
+    void release();
+    void evict(Uint budget);
+};
+
@@ -0,0 +1,17 @@
+#pragma once
+
+
+// Platform layer.
+//  - Portable: The core (code/core), the widgets in code/widgets except
+//    text, CPU_Backend and its kernels, Thread_Pool and Spatial_Index. They
+//    don't include platform headers.
+//  - Win32 only (CPP_GUI_WIN32): win32.hpp, d2d.hpp, D2D_Backend, the D2D
+//    caches and text (DirectWrite), including Text_Widget.
+//  - Stack segments pick an implementation per platform (see
+//    stack_segments.cpp).
+
+#if defined(_WIN32)
+    #define CPP_GUI_WIN32 1
+#else
+    #define CPP_GUI_WIN32 0
+#endif
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cpp-gui/common.hpp>
+
+
+// Premultiplied 8 bit color math, shared by the software paths (CPU_Backend,
+// Rounded_Rect_Kernel, D2D_Cache's shadow bitmaps).
+//  - Packed colors are RGBA8, R in the lowest byte. The per channel helpers
+//    don't depend on the order.
+//  - The SIMD paths compute the same values (bit for bit).
+
+// [0, 1] -> [0, 255], rounded. Clamps.
+inline Uint32 quantize_coverage(Float32 coverage) {
+    return (Uint32)(min(max(coverage, 0.0f), 1.0f)*255.0f + 0.5f);
+}
+
+// A straight channel times `alpha` (in [0, 1]), as [0, 255].
+inline Uint32 premultiply_channel(Float32 value, Float32 alpha) {
+    return (Uint32)(min(max(value, 0.0f), 1.0f)*alpha*255.0f + 0.5f);
+}
+
+inline Uint32 pack_premultiplied(V4f color) {
+    auto alpha = min(max(color.a, 0.0f), 1.0f);
+
+    return (premultiply_channel(color.r, alpha) <<  0)
+         | (premultiply_channel(color.g, alpha) <<  8)
+         | (premultiply_channel(color.b, alpha) << 16)
+         | (quantize_coverage(alpha)            << 24);
+}
+
+// x/255, rounded. Exact for x <= 255*255.
+inline Uint32 div_255(Uint32 x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// Scales all channels by coverage/255.
+inline Uint32 scale_color(Uint32 color, Uint32 coverage) {
+    auto result = Uint32(0);
+    for(Uint32 shift = 0; shift < 32; shift += 8) {
+        result |= div_255(((color >> shift) & 0xff)*coverage) << shift;
+    }
+    return result;
+}
+
+// Source over. Doesn't overflow, as `source` is premultiplied.
+inline Uint32 blend(Uint32 dest, Uint32 source) {
+    auto inverse_alpha = 255 - (source >> 24);
+
+    auto result = Uint32(0);
+    for(Uint32 shift = 0; shift < 32; shift += 8) {
+        auto d = (dest   >> shift) & 0xff;
+        auto s = (source >> shift) & 0xff;
+        result |= (div_255(d*inverse_alpha) + s) << shift;
+    }
+    return result;
+}
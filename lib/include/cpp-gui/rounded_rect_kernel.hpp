@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cpp-gui/common.hpp>
+
+
+// Anti-aliased rounded rect fill and stroke, from signed distances.
+//  - Geometry matches Rounded_Widget::on_hit_test: Corners are circles of
+//    `radius`, centered `radius` inside the rect, and the radius is clamped
+//    to half the size (like get_effective_corner_radius). Pixels whose
+//    centers hit are at least half covered.
+//  - Fill coverage is 0.5 - distance. Stroke coverage is the overlap of the
+//    pixel and the stroke across the stroke shape's edge.
+//  - Fill and stroke are blended in one pass: The fill, then the stroke on
+//    top.
+//  - Colors are premultiplied RGBA8, R in the lowest byte, blended source
+//    over.
+//  - Kernels: Scalar, SSE2 (4 pixels at a time) and AVX2 (8 pixels at a
+//    time). The best one the CPU supports is used. They all produce the same
+//    bytes.
+struct Rounded_Rect_Kernel {
+    enum class Level : Uint32 {
+        scalar,
+        sse2,
+        avx2,
+    };
+
+    // Pixel coordinates.
+    struct Shape {
+        V2f     center;
+        V2f     half_size;
+        Float32 radius;
+    };
+
+    Shape   fill_shape        = {};
+    Uint32  fill_color        = 0; // 0: no fill.
+    Shape   stroke_shape      = {};
+    Uint32  stroke_color      = 0; // 0: no stroke.
+    Float32 stroke_half_width = 0.5f;
+
+
+    // The radius is clamped to [0, half the size].
+    static Shape make_shape(V2f min, V2f max, Float32 radius);
+
+    // Checked once.
+    static Level get_supported_level();
+    static const char* get_level_name(Level level);
+
+    // Blends `count` pixels of the row at `y`, starting at pixel `x`.
+    //  - `row` points at the row's first pixel.
+    //  - Levels the CPU doesn't support fall back to lower ones.
+    void blend_span(Uint32* row, Sint32 x, Sint32 y, Uint count) const;
+    void blend_span(Level level, Uint32* row, Sint32 x, Sint32 y, Uint count) const;
+};
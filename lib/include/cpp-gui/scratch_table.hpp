@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cpp-gui/common.hpp>
+
+
+// Open addressing hash table from keys to Uint32 values for temporary use.
+//  - `begin` clears the table by bumping a generation. Slots of older
+//    generations are empty, so the memory is reused without touching it.
+//  - Grows only in `begin`: Pass the number of entries that will be inserted.
+//  - Linear probing, load factor <= 0.5.
+template <typename K, typename Hash>
+struct Scratch_Table {
+    struct Slot {
+        K      key;
+        Uint32 value;
+        Uint32 generation; // 0: never used.
+    };
+
+    List<Slot> slots;
+    Uint32     generation = 0;
+
+
+    void begin(Uint capacity) {
+        auto needed = Uint(16);
+        while(needed < 2*capacity) {
+            needed *= 2;
+        }
+
+        if(this->slots.size() < needed) {
+            this->slots.clear();
+            this->slots.resize(needed, Slot {});
+            this->generation = 1;
+        }
+        else {
+            this->generation += 1;
+
+            if(this->generation == 0) {
+                for(auto& slot : this->slots) {
+                    slot.generation = 0;
+                }
+                this->generation = 1;
+            }
+        }
+    }
+
+    // Keeps the existing value if the key is already in the table.
+    void insert(const K& key, Uint32 value) {
+        auto mask  = this->slots.size() - 1;
+        auto index = Uint(Hash()(key)) & mask;
+
+        while(true) {
+            auto& slot = this->slots[index];
+
+            if(slot.generation != this->generation) {
+                slot.key        = key;
+                slot.value      = value;
+                slot.generation = this->generation;
+                return;
+            }
+
+            if(slot.key == key) {
+                return;
+            }
+
+            index = (index + 1) & mask;
+        }
+    }
+
+    // Returns nullptr if the key isn't in the table.
+    const Uint32* find(const K& key) const {
+        auto mask  = this->slots.size() - 1;
+        auto index = Uint(Hash()(key)) & mask;
+
+        while(true) {
+            auto& slot = this->slots[index];
+
+            if(slot.generation != this->generation) {
+                return nullptr;
+            }
+
+            if(slot.key == key) {
+                return &slot.value;
+            }
+
+            index = (index + 1) & mask;
+        }
+    }
+};
+
+
+struct Pointer_Hash {
+    Uint operator()(const void* pointer) const {
+        // Fibonacci hashing. Low bits of pointers are mostly zero.
+        auto x = (Uint64)(Uint)pointer * 0x9E3779B97F4A7C15ull;
+        return Uint(x >> 32);
+    }
+};
+
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cpp-gui/common.hpp>
+
+
+// Coverage of a blurred rounded rect, evaluated analytically per pixel.
+//  - The blur is a Gaussian with a standard deviation of blur_radius/3, cut
+//    off at the blur radius (like D2D's Gaussian blur effect).
+//  - Rows through the straight part of the rect are separable: The
+//    coverage is the product of two erf differences.
+//  - Rows through the corner bands have a varying width, so the integral
+//    along y is split into slices of half a standard deviation of arc
+//    length. Each slice gets its exact Gaussian mass and its average width.
+//    This is within 1/255 of a reference Gaussian blur.
+//  - Coverage only depends on y through `Row`, which is computed once per
+//    row. Spans are evaluated 4 pixels at a time (SSE2, where available).
+struct Shadow_Kernel {
+    static const Uint max_band_slice_count = 24;
+
+    struct Row {
+        Float32 straight_weight; // Gaussian mass of the straight part.
+        Uint32  sample_count;     // corner slices.
+        Float32 half_widths[2*max_band_slice_count];
+        Float32 weights[2*max_band_slice_count];
+    };
+
+    V2f     center;
+    V2f     half_size;
+    Float32 radius;
+    Float32 blur_radius;
+
+    Float32 erf_scale; // 1/(sqrt(2)*sigma).
+
+
+    // `blur_radius` must be positive. `radius` is clamped to the half size.
+    void create(V2f center, V2f half_size, Float32 radius, Float32 blur_radius);
+
+    Row get_row(Float32 y) const;
+
+    // Coverage (0-1) at a point.
+    Float32 get_coverage(V2f point) const;
+
+    // Coverage (0-255) of `count` pixels of a row, starting at pixel `x`
+    // (pixel centers are at x + 0.5).
+    void get_span_coverage(const Row& row, Sint32 x, Uint count, Uint8* coverage) const;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cpp-gui/common.hpp>
+
+
+struct Widget;
+
+
+// Bounding volume hierarchy over widget rects.
+//  - Bulk loaded from a list of widgets (position and size).
+//  - Answers point queries with the indices of the widgets whose rects
+//    contain the point.
+//  - Doesn't track the widgets. Build it again when they move.
+struct Spatial_Index {
+    struct Node {
+        V2f    min;
+        V2f    max;
+        Uint32 begin; // leaf: range in `items`. inner: first child node.
+        Uint32 count; // leaf: item count. inner: 0.
+    };
+
+    struct Item {
+        V2f    min;
+        V2f    max;
+        Uint32 index;
+    };
+
+    List<Node> nodes;
+    List<Item> items;
+
+
+    void build(const List<Widget*>& widgets);
+
+    void clear();
+
+    // Appends the indices of the hit widgets to `result` in no particular
+    // order.
+    void query(V2f point, List<Uint32>* result) const;
+};
+
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <cpp-gui/common.hpp>
+
+
+// Runs batches of indexed jobs on worker threads.
+//  - `run` returns once all jobs are done. The calling thread works on the
+//    batch too, so a pool of n threads has n - 1 workers.
+//  - Jobs are claimed one at a time from a shared counter: Threads that
+//    finish early take the remaining jobs, which balances uneven jobs.
+//  - Jobs of a batch must be independent.
+struct Thread_Pool {
+    List<std::thread> workers;
+
+    std::mutex              mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // Current batch.
+    const Function_Ref<void(Uint index)>* job = nullptr;
+    Uint              job_count    = 0;
+    std::atomic<Uint> next_job     { 0 };
+    Uint              active_count = 0;
+    Uint64            generation   = 0;
+    Bool              quit         = false;
+
+
+    void create(Uint thread_count);
+    void destroy();
+
+    Uint get_thread_count() const { return this->workers.size() + 1; }
+
+    void run(Uint job_count, Function_Ref<void(Uint index)> job);
+
+    // Runs jobs of the current batch until there are none left.
+    void work();
+};
+
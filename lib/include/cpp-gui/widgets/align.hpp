@@ -17,4 +17,6 @@ struct Align_Widget : virtual Single_Child_Widget {
     virtual Bool on_try_match(Def* def) override;
 
     virtual void on_layout(Box_Constraints constraints) override;
+
+    virtual Bool sized_by_parent() override { return true; }
 };
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <cpp-gui/core/widget.hpp>
+#include <cpp-gui/spatial_index.hpp>
 
 
 struct Multi_Child_Def : virtual Def {
     List<Def*> children;
+    Bool       use_spatial_index = false;
 
     virtual ~Multi_Child_Def();
 
@@ -15,12 +17,25 @@ struct Multi_Child_Def : virtual Def {
 struct Multi_Child_Widget : virtual Widget {
     List<Widget*> children;
 
+    // Edits of the last match. Layout is only invalidated if there were any.
+    Reconcile_Edits edits;
+
+    // Spatial index for hit testing.
+    //  - Opt-in, for many (eg: absolutely positioned) children. Children are
+    //    assumed to only be hit inside their rects.
+    //  - Built lazily by the first hit test after a layout.
+    Bool          use_spatial_index;
+    Spatial_Index spatial_index;
+    Uint32        spatial_index_version;
+    Bool          spatial_index_valid;
+    List<Uint32>  spatial_index_hits;
+
     virtual ~Multi_Child_Widget() override;
 
     virtual void match(const Multi_Child_Def& def);
     virtual Bool on_try_match(Def* def) override;
 
-    virtual void on_paint(ID2D1RenderTarget* target) override;
+    virtual void on_paint(Display_List* list) override;
 
-    virtual Bool visit_children_for_hit_testing(std::function<Bool(Widget* child)> visitor, V2f point) override;
+    virtual Bool visit_children_for_hit_testing(Function_Ref<Bool(Widget* child)> visitor, V2f point) override;
 };
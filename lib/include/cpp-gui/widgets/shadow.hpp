@@ -12,6 +12,9 @@ struct Shadow_Fields {
     Float32 shadow_corner_radius = -1.0f; // negative to use widget's radius.
 
     V2f get_effective_size(V2f base_size);
+
+    // The shadow's rect for a widget of size `base_size` (before blurring).
+    Paint_Bounds get_shadow_rect(V2f base_size);
 };
 
 
@@ -24,6 +27,9 @@ struct Shadow_Widget : virtual Widget, Shadow_Fields {
     virtual void match(const Shadow_Def& def);
     virtual Bool on_try_match(Def* def) override;
 
-    virtual void on_paint(ID2D1RenderTarget* target);
+    virtual void on_paint(Display_List* list);
+
+    // The widget's rect and the blurred shadow.
+    virtual Paint_Bounds get_paint_bounds() override;
 };
 
@@ -22,8 +22,8 @@ struct Single_Child_Widget : virtual Widget {
 
     virtual void on_layout(Box_Constraints constraints) override;
 
-    virtual void on_paint(ID2D1RenderTarget* target) override;
+    virtual void on_paint(Display_List* list) override;
 
-    virtual Bool visit_children_for_hit_testing(std::function<Bool(Widget* child)> visitor, V2f point) override;
+    virtual Bool visit_children_for_hit_testing(Function_Ref<Bool(Widget* child)> visitor, V2f point) override;
 };
 
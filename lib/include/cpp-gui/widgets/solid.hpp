@@ -20,6 +20,6 @@ struct Solid_Widget : virtual Widget {
 
     virtual Bool blocks_mouse() override { return true; }
 
-    virtual void on_paint(ID2D1RenderTarget* target);
+    virtual void on_paint(Display_List* list);
 };
 
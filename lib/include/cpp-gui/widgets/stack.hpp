@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cpp-gui/widgets/multi_child.hpp>
+
+
+struct Stack_Def : virtual Multi_Child_Def {
+    Axis      axis        = Axis::x;
+    Direction direction   = Direction::min;  // edge where the first child is.
+    Float32   cross_align = 0.0f;            // 0: min edge, 1: max edge.
+
+    virtual Widget* on_get_widget(Gui* gui) override;
+};
+
+
+struct Stack_Widget : virtual Multi_Child_Widget {
+    Axis      axis;
+    Direction direction;
+    Float32   cross_align;
+
+    // Child extents along the axis, measured from the first child's edge.
+    //  - Child i covers [child_offsets[i], child_offsets[i + 1]).
+    //  - Has children.size() + 1 entries after layout.
+    List<Float32> child_offsets;
+
+    // Returns the children that overlap [range_min, range_max) along the axis
+    // (in this widget's coordinates).
+    Range<Uint> get_children_in_range(Float32 range_min, Float32 range_max);
+
+
+    virtual void match(const Stack_Def& def);
+    virtual Bool on_try_match(Def* def) override;
+
+    virtual void on_layout(Box_Constraints constraints) override;
+
+    // The children that overlap `visible` along the axis.
+    virtual Range<Uint> get_children_to_replay(Paint_Bounds visible) override;
+
+    virtual Bool visit_children_for_hit_testing(Function_Ref<Bool(Widget* child)> visitor, V2f point) override;
+};
+
@@ -23,6 +23,8 @@ struct Text_Widget : virtual Widget {
     virtual void match(const Text_Def& def);
     virtual Bool on_try_match(Def* def) override;
 
-    virtual void on_paint(ID2D1RenderTarget* target) override;
+    virtual void on_layout(Box_Constraints constraints) override;
+
+    virtual void on_paint(Display_List* list) override;
 };
 
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <cpp-gui/platform.hpp>
+
+#if CPP_GUI_WIN32 == 0
+    #error "win32.hpp is part of the Win32 platform layer (see platform.hpp)."
+#endif
+
 #ifdef UNICODE
 #undef UNICODE
 #endif
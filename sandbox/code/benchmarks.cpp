@@ -0,0 +1,814 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <unordered_map>
+
+#include <cpp-gui/core/gui.hpp>
+#include <cpp-gui/widgets/padding.hpp>
+#include <cpp-gui/widgets/solid.hpp>
+#include <cpp-gui/widgets/stack.hpp>
+#include <cpp-gui/cpu_backend.hpp>
+
+#include "benchmarks.hpp"
+
+
+using Benchmark_Clock = std::chrono::steady_clock;
+
+static Float64 get_milliseconds_since(Benchmark_Clock::time_point start) {
+    return std::chrono::duration<Float64, std::milli>(Benchmark_Clock::now() - start).count();
+}
+
+
+// Heap allocations.
+//  - The global operator new is replaced to count them. (In the
+//    executables that link the benchmarks.)
+static std::atomic<Uint64> heap_allocation_count { 0 };
+
+void* operator new(std::size_t size) {
+    heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    auto result = malloc(size > 0 ? size : 1);
+    if(result == nullptr) {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+// Sized deletes (C++14) come here. Without it, they'd use the library's.
+void operator delete(void* pointer, std::size_t size) noexcept {
+    UNUSED(size);
+    ::operator delete(pointer);
+}
+
+static Uint64 get_heap_allocation_count() {
+    return heap_allocation_count.load(std::memory_order_relaxed);
+}
+
+// Allocations from the Gui's widget pools.
+static Uint64 get_widget_allocation_count(Gui* gui) {
+    auto count = Uint64(0);
+    for(auto pool : gui->widget_pools) {
+        if(pool != nullptr) {
+            count += pool->allocation_count;
+        }
+    }
+    return count;
+}
+
+
+
+// Fills its constraints.
+struct Filled_Solid_Widget : Solid_Widget {
+    virtual void on_layout(Box_Constraints constraints) override {
+        this->size = constraints.max;
+    }
+};
+
+// A chain of Padding widgets `depth` levels deep, with `leaf` at the bottom.
+static Def* make_padding_chain(Gui* gui, Uint depth, Widget* leaf) {
+    auto def = (Def*)gui->create_def<Widget_Def>(leaf);
+    for(Uint i = 0; i < depth; i += 1) {
+        auto padding = gui->create_def<Padding_Def>();
+        padding->child   = def;
+        padding->pad_min = V2f { 0.0f, 0.0f };
+        padding->pad_max = V2f { 0.0f, 0.0f };
+        def = padding;
+    }
+
+    return def;
+}
+
+// Stress test for deep trees: 1k, 10k and 100k levels.
+//  - build:    set_root from scratch.
+//  - rebuild:  set_root with a new def tree. Every widget is reused.
+//  - layout:   The root's constraints change -> every level is laid out.
+//  - paint:    A full frame on a small CPU_Backend.
+//  - hit test: Through every level.
+//  - teardown: Gui::destroy.
+void run_deep_tree_benchmark() {
+    auto const target_size = V2f { 256, 256 };
+
+    printf("deep trees:\n");
+
+    for(auto depth : { Uint(1000), Uint(10000), Uint(100000) }) {
+        auto gui = Gui {};
+        gui.create(nullptr, []() {});
+        gui.synchronous_teardown = true;
+
+        auto backend = CPU_Backend {};
+        backend.create(Uint32(target_size.x), Uint32(target_size.y));
+
+        auto leaf = gui.create_widget<Filled_Solid_Widget>();
+        leaf->fill_color   = V4f { 0.29f, 0.56f, 0.89f, 1.0f };
+        leaf->stroke_color = V4f { 0.0f, 0.0f, 0.0f, 0.0f };
+
+        auto start = Benchmark_Clock::now();
+        gui.set_root(make_padding_chain(&gui, depth, leaf));
+        auto build_ms = get_milliseconds_since(start);
+
+        start = Benchmark_Clock::now();
+        gui.set_root(make_padding_chain(&gui, depth, leaf));
+        auto rebuild_ms = get_milliseconds_since(start);
+
+        gui.render_frame(target_size, &backend);
+
+        start = Benchmark_Clock::now();
+        gui.root_widget->layout(Box_Constraints::tight(target_size - V2f { 1, 1 }));
+        auto layout_ms = get_milliseconds_since(start);
+
+        start = Benchmark_Clock::now();
+        gui.damage_all();
+        gui.render_frame(target_size, &backend);
+        auto paint_ms = get_milliseconds_since(start);
+
+        auto hits = List<Widget*>();
+        start = Benchmark_Clock::now();
+        gui.root_widget->hit_test(V2f { 10, 10 }, [](Widget*) { return false; }, &hits);
+        auto hit_test_ms = get_milliseconds_since(start);
+
+        auto segment_count = gui.stack_segments.size();
+
+        start = Benchmark_Clock::now();
+        gui.destroy();
+        auto teardown_ms = get_milliseconds_since(start);
+
+        backend.destroy();
+
+        printf(
+            "  depth %6zu: build %.2f ms, rebuild %.2f ms, layout %.2f ms, paint %.2f ms, "
+            "hit test %.2f ms (%zu hits), teardown %.2f ms, %zu stack segments.\n",
+            depth, build_ms, rebuild_ms, layout_ms, paint_ms,
+            hit_test_ms, hits.size(), teardown_ms, segment_count
+        );
+    }
+}
+
+
+
+// A fixed size cell that takes mouse input.
+struct Hover_Cell_Widget : virtual Widget {
+    static Uint64 enter_count;
+    static Uint64 move_count;
+
+    virtual void on_layout(Box_Constraints constraints) override {
+        UNUSED(constraints);
+        this->size = V2f { 8, 8 };
+    }
+
+    virtual Bool takes_mouse_input() override { return true; }
+
+    virtual void on_mouse_enter() override { enter_count += 1; }
+
+    virtual Bool on_mouse_move() override {
+        move_count += 1;
+        return true;
+    }
+};
+
+Uint64 Hover_Cell_Widget::enter_count = 0;
+Uint64 Hover_Cell_Widget::move_count  = 0;
+
+// Mouse moves over 100k widgets: 1000 rows of 100 cells.
+//  - Each move hit tests through the row stacks, diffs the hot list and
+//    sends leave/enter/move events.
+//  - Counts heap and widget pool allocations during the moves. The scratch
+//    buffers (hit list, hot lists, hit test stack) are warmed up first, so
+//    both should be 0.
+void run_mouse_move_benchmark() {
+    auto const row_count    = Uint(1000);
+    auto const column_count = Uint(100);
+    auto const move_count   = Uint(100000);
+
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+
+    auto rows = gui.create_def<Stack_Def>();
+    rows->axis = Axis::y;
+    for(Uint i = 0; i < row_count; i += 1) {
+        auto row = gui.create_def<Stack_Def>();
+        row->axis = Axis::x;
+        for(Uint j = 0; j < column_count; j += 1) {
+            row->children.push_back(gui.create_def<Widget_Def>(gui.create_widget<Hover_Cell_Widget>()));
+        }
+        rows->children.push_back(row);
+    }
+
+    gui.set_root(rows);
+
+    auto grid_size = V2f { 8.0f*column_count, 8.0f*row_count };
+    gui.root_widget->layout(Box_Constraints::tight(grid_size));
+    gui.flush_layout_queue();
+
+    // A path that enters a new cell on most moves.
+    auto get_position = [&](Uint i) {
+        return V2f {
+            fmodf(3.7f*Float32(i), grid_size.x),
+            fmodf(5.3f*Float32(i), grid_size.y),
+        };
+    };
+
+    for(Uint i = 0; i < 100; i += 1) {
+        gui.on_mouse_move(get_position(i));
+    }
+
+    Hover_Cell_Widget::enter_count = 0;
+    Hover_Cell_Widget::move_count  = 0;
+
+    auto heap_allocations   = get_heap_allocation_count();
+    auto widget_allocations = get_widget_allocation_count(&gui);
+
+    auto start = Benchmark_Clock::now();
+    for(Uint i = 0; i < move_count; i += 1) {
+        gui.on_mouse_move(get_position(100 + i));
+    }
+    auto move_ms = get_milliseconds_since(start);
+
+    heap_allocations   = get_heap_allocation_count() - heap_allocations;
+    widget_allocations = get_widget_allocation_count(&gui) - widget_allocations;
+
+    printf(
+        "mouse moves: %zu widgets, %zu moves, %.3f us/move, %llu enter events, %llu move events, "
+        "%llu heap allocations, %llu widget allocations.\n",
+        row_count*column_count, move_count, 1000.0*move_ms/Float64(move_count),
+        (unsigned long long)Hover_Cell_Widget::enter_count,
+        (unsigned long long)Hover_Cell_Widget::move_count,
+        (unsigned long long)heap_allocations,
+        (unsigned long long)widget_allocations
+    );
+
+    gui.destroy();
+}
+
+
+
+// Counts on_layout calls.
+struct Counted_Widget : virtual Widget {
+    static Uint64 layout_count;
+
+    V2f fixed_size = { 8, 8 };
+
+    virtual void on_layout(Box_Constraints constraints) override {
+        UNUSED(constraints);
+        layout_count += 1;
+        this->size = this->fixed_size;
+    }
+};
+
+Uint64 Counted_Widget::layout_count = 0;
+
+// Layout per frame with one dirty widget next to a clean subtree of 1k, 10k
+// and 100k widgets.
+//  - The dirty widget changes its size every frame (like a button that
+//    grows when hovered). The root is laid out again, the clean subtree
+//    keeps its layout.
+//  - The cost per frame should not depend on the subtree's size. The full
+//    layout (first frame) is shown for comparison.
+void run_incremental_layout_benchmark() {
+    auto const frame_count = Uint(1000);
+    auto const constraints = Box_Constraints { V2f { 0, 0 }, V2f { 1000, 1000000 } };
+
+    printf("incremental layout:\n");
+
+    for(auto widget_count : { Uint(1000), Uint(10000), Uint(100000) }) {
+        auto gui = Gui {};
+        gui.create(nullptr, []() {});
+        gui.synchronous_teardown = true;
+
+        auto hot = gui.create_widget<Counted_Widget>();
+
+        auto clean = gui.create_def<Stack_Def>();
+        clean->axis = Axis::y;
+        for(Uint i = 0; i < widget_count; i += 1) {
+            clean->children.push_back(gui.create_def<Widget_Def>(gui.create_widget<Counted_Widget>()));
+        }
+
+        auto root = gui.create_def<Stack_Def>();
+        root->axis = Axis::y;
+        root->children.push_back(gui.create_def<Widget_Def>(hot));
+        root->children.push_back(clean);
+        gui.set_root(root);
+
+        Counted_Widget::layout_count = 0;
+        auto start = Benchmark_Clock::now();
+        gui.root_widget->layout(constraints);
+        gui.flush_layout_queue();
+        auto full_ms = get_milliseconds_since(start);
+
+        Counted_Widget::layout_count = 0;
+        start = Benchmark_Clock::now();
+        for(Uint frame = 0; frame < frame_count; frame += 1) {
+            hot->fixed_size.y = (frame % 2 == 0) ? 20.0f : 8.0f;
+            hot->mark_for_layout();
+
+            gui.root_widget->layout(constraints);
+            gui.flush_layout_queue();
+        }
+        auto frame_ms = get_milliseconds_since(start)/Float64(frame_count);
+
+        printf(
+            "  clean subtree of %6zu: full layout %.3f ms, frame %.4f ms, %.1f on_layout calls per frame.\n",
+            widget_count, full_ms, frame_ms,
+            Float64(Counted_Widget::layout_count)/Float64(frame_count)
+        );
+
+        gui.destroy();
+    }
+}
+
+
+
+// A keyed list of 50k rows (padded solid rects) with 10% churn per frame.
+//  - Each frame drops the first 5k rows and appends 5k new ones.
+//  - Once with the widget pools, once with new/delete. The difference is
+//    allocator time.
+void run_keyed_churn_benchmark() {
+    auto const row_count   = Uint(50000);
+    auto const churn_count = row_count/10;
+    auto const frame_count = Uint(20);
+
+    printf("keyed churn (%zu rows, %zu new per frame):\n", row_count, churn_count);
+
+    for(auto use_widget_pools : { true, false }) {
+        auto gui = Gui {};
+        gui.create(nullptr, []() {});
+        gui.synchronous_teardown = true;
+        gui.use_widget_pools     = use_widget_pools;
+
+        auto build = [&](Uint first_key) {
+            auto list = gui.create_def<Stack_Def>();
+            list->axis = Axis::y;
+            list->children.reserve(row_count);
+
+            for(Uint i = 0; i < row_count; i += 1) {
+                auto solid = gui.create_def<Solid_Def>();
+                solid->fill_color   = V4f { 0.29f, 0.56f, 0.89f, 1.0f };
+                solid->stroke_color = V4f { 0.0f, 0.0f, 0.0f, 0.0f };
+
+                auto row = gui.create_def<Padding_Def>();
+                row->child   = solid;
+                row->pad_min = V2f { 2.0f, 1.0f };
+                row->pad_max = V2f { 2.0f, 1.0f };
+                row->with_key(Key::from_uint(first_key + i));
+                list->children.push_back(row);
+            }
+
+            gui.set_root(list);
+        };
+
+        auto start = Benchmark_Clock::now();
+        build(0);
+        auto build_ms = get_milliseconds_since(start);
+
+        start = Benchmark_Clock::now();
+        for(Uint frame = 1; frame <= frame_count; frame += 1) {
+            build(frame*churn_count);
+        }
+        auto frame_ms = get_milliseconds_since(start)/Float64(frame_count);
+
+        printf(
+            "  %s: build %.2f ms, churn frame %.2f ms.\n",
+            use_widget_pools ? "pools" : "new  ", build_ms, frame_ms
+        );
+
+        for(auto pool : gui.widget_pools) {
+            if(pool == nullptr || pool->allocation_count == 0) {
+                continue;
+            }
+
+            printf(
+                "    %s: %zu live, %zu peak, %llu allocations, %zu KiB in slabs.\n",
+                pool->type_name, pool->live_count, pool->peak_count,
+                (unsigned long long)pool->allocation_count, pool->get_slab_bytes()/1024
+            );
+        }
+
+        gui.destroy();
+    }
+}
+
+
+
+// The keys before value keys, for comparison.
+//  - Heap objects. Each def had one, each widget a clone.
+//  - A virtual equal_to with a dynamic_cast, a virtual hash.
+struct Heap_Key {
+    virtual ~Heap_Key() {}
+    virtual Bool equal_to(const Heap_Key* other) = 0;
+    virtual Uint hash() = 0;
+    virtual Heap_Key* clone() const = 0;
+};
+
+template <typename T>
+struct T_Heap_Key : virtual Heap_Key {
+    T value;
+
+    T_Heap_Key(const T& value) : value(value) {}
+
+    virtual Bool equal_to(const Heap_Key* other) final override {
+        auto _other = dynamic_cast<const T_Heap_Key<T>*>(other);
+        if(_other == nullptr) {
+            return false;
+        }
+
+        return this->value == _other->value;
+    }
+
+    virtual Uint hash() final override {
+        return std::hash<T>()(this->value);
+    }
+
+    virtual Heap_Key* clone() const final override {
+        return new T_Heap_Key<T>(this->value);
+    }
+};
+
+struct Heap_Key_Pointer {
+    Heap_Key* key;
+};
+
+static Bool operator==(Heap_Key_Pointer left, Heap_Key_Pointer right) {
+    return left.key->equal_to(right.key);
+}
+
+struct Heap_Key_Pointer_Hash {
+    std::size_t operator()(Heap_Key_Pointer pointer) const {
+        return pointer.key->hash();
+    }
+};
+
+// Keyed matching of 100k rows, old keys against value keys.
+//  - Both: The old rows' keys go into a table, the new rows (in reverse
+//    order) are looked up and compared, like reconcile_list and try_match.
+//  - Old path: T_Key<Uint> (a heap key per def, a clone per widget) and a
+//    std::unordered_map. Value keys: Key::from_uint and a Scratch_Table.
+//  - Then the real thing: set_root with 100k keyed rows in reverse order.
+//    The heap allocations don't depend on the row count (no key
+//    allocations).
+void run_key_benchmark() {
+    auto const row_count = Uint(100000);
+
+    printf("keys (%zu rows):\n", row_count);
+
+    // Old path.
+    {
+        auto start       = Benchmark_Clock::now();
+        auto allocations = get_heap_allocation_count();
+
+        auto widget_keys = List<Heap_Key*>();
+        widget_keys.reserve(row_count);
+        for(Uint i = 0; i < row_count; i += 1) {
+            auto def_key = T_Heap_Key<Uint>(i);
+            widget_keys.push_back(def_key.clone());
+        }
+
+        auto key_to_index = std::unordered_map<Heap_Key_Pointer, Uint, Heap_Key_Pointer_Hash>();
+        for(Uint i = 0; i < row_count; i += 1) {
+            key_to_index.insert({ Heap_Key_Pointer { widget_keys[i] }, i });
+        }
+
+        auto matches = Uint(0);
+        for(Uint i = 0; i < row_count; i += 1) {
+            auto def_key = (Heap_Key*)new T_Heap_Key<Uint>(row_count - 1 - i);
+
+            auto it = key_to_index.find(Heap_Key_Pointer { def_key });
+            if(it != key_to_index.end() && def_key->equal_to(widget_keys[it->second])) {
+                matches += 1;
+            }
+
+            delete def_key;
+        }
+
+        allocations = get_heap_allocation_count() - allocations;
+        auto ms = get_milliseconds_since(start);
+
+        for(auto key : widget_keys) {
+            delete key;
+        }
+
+        printf(
+            "  T_Key<Uint>: %.2f ms, %zu matches, %llu heap allocations.\n",
+            ms, matches, (unsigned long long)allocations
+        );
+    }
+
+    // Value keys.
+    {
+        auto key_to_index = Scratch_Table<Key, std::hash<Key>>();
+
+        auto start       = Benchmark_Clock::now();
+        auto allocations = get_heap_allocation_count();
+
+        auto widget_keys = List<Key>();
+        widget_keys.reserve(row_count);
+        for(Uint i = 0; i < row_count; i += 1) {
+            widget_keys.push_back(Key::from_uint(i));
+        }
+
+        key_to_index.begin(row_count);
+        for(Uint i = 0; i < row_count; i += 1) {
+            key_to_index.insert(widget_keys[i], Uint32(i));
+        }
+
+        auto matches = Uint(0);
+        for(Uint i = 0; i < row_count; i += 1) {
+            auto def_key = Key::from_uint(row_count - 1 - i);
+
+            auto index = key_to_index.find(def_key);
+            if(index != nullptr && def_key == widget_keys[*index]) {
+                matches += 1;
+            }
+        }
+
+        allocations = get_heap_allocation_count() - allocations;
+        auto ms = get_milliseconds_since(start);
+
+        printf(
+            "  Key:         %.2f ms, %zu matches, %llu heap allocations.\n",
+            ms, matches, (unsigned long long)allocations
+        );
+    }
+
+    // reconcile_list.
+    {
+        auto gui = Gui {};
+        gui.create(nullptr, []() {});
+        gui.synchronous_teardown = true;
+
+        auto make_rows = [&](Bool reversed) {
+            auto list = gui.create_def<Stack_Def>();
+            list->axis = Axis::y;
+            list->children.reserve(row_count);
+
+            for(Uint i = 0; i < row_count; i += 1) {
+                auto row = gui.create_def<Solid_Def>();
+                row->fill_color   = V4f { 0.29f, 0.56f, 0.89f, 1.0f };
+                row->stroke_color = V4f { 0.0f, 0.0f, 0.0f, 0.0f };
+                row->with_key(Key::from_uint(reversed ? row_count - 1 - i : i));
+                list->children.push_back(row);
+            }
+
+            return list;
+        };
+
+        gui.set_root(make_rows(false));
+
+        auto rows = make_rows(true);
+
+        auto start              = Benchmark_Clock::now();
+        auto allocations        = get_heap_allocation_count();
+        auto widget_allocations = get_widget_allocation_count(&gui);
+
+        gui.set_root(rows);
+
+        allocations        = get_heap_allocation_count() - allocations;
+        widget_allocations = get_widget_allocation_count(&gui) - widget_allocations;
+        auto ms = get_milliseconds_since(start);
+
+        printf(
+            "  reconcile (reversed): %.2f ms, %llu heap allocations, %llu widget allocations.\n",
+            ms, (unsigned long long)allocations, (unsigned long long)widget_allocations
+        );
+
+        gui.destroy();
+    }
+}
+
+
+
+enum class Child_Def_Kind {
+    keyed,
+    unkeyed,
+    mixed,
+};
+
+// Rebuilds of one list with 2, 16, 1k and 100k children, every child
+// reused.
+//  - keyed:   Every def has a key.
+//  - unkeyed: No keys. (The small list path, for any size.)
+//  - mixed:   Keyed defs, unkeyed defs and Widget_Defs in turn.
+//  - Creating the defs and reconciling are timed separately. Heap
+//    allocations are per rebuild, after a warm up rebuild.
+void run_reconcile_list_benchmark() {
+    printf("reconcile_list:\n");
+
+    auto kinds = { Child_Def_Kind::keyed, Child_Def_Kind::unkeyed, Child_Def_Kind::mixed };
+    auto kind_names = { "keyed  ", "unkeyed", "mixed  " };
+
+    for(auto child_count : { Uint(2), Uint(16), Uint(1000), Uint(100000) }) {
+        auto rebuild_count = max(Uint(10), Uint(1000000)/child_count);
+
+        auto kind_name = kind_names.begin();
+        for(auto kind : kinds) {
+            auto gui = Gui {};
+            gui.create(nullptr, []() {});
+            gui.synchronous_teardown = true;
+
+            auto widgets = List<Solid_Widget*>();
+            for(Uint i = 0; i < child_count; i += 1) {
+                auto widget = gui.create_widget<Solid_Widget>();
+                widget->fill_color   = V4f { 0.29f, 0.56f, 0.89f, 1.0f };
+                widget->stroke_color = V4f { 0.0f, 0.0f, 0.0f, 0.0f };
+                widgets.push_back(widget);
+            }
+
+            auto make_list = [&]() {
+                auto list = gui.create_def<Stack_Def>();
+                list->axis = Axis::y;
+                list->children.reserve(child_count);
+
+                for(Uint i = 0; i < child_count; i += 1) {
+                    auto use_key = kind == Child_Def_Kind::keyed
+                        || (kind == Child_Def_Kind::mixed && i % 3 == 0);
+
+                    if(kind == Child_Def_Kind::mixed && i % 3 == 2) {
+                        list->children.push_back(gui.create_def<Widget_Def>(widgets[i]));
+                        continue;
+                    }
+
+                    auto child = gui.create_def<Solid_Def>();
+                    child->fill_color   = V4f { 0.29f, 0.56f, 0.89f, 1.0f };
+                    child->stroke_color = V4f { 0.0f, 0.0f, 0.0f, 0.0f };
+                    if(use_key) {
+                        child->with_key(Key::from_uint(i));
+                    }
+                    list->children.push_back(child);
+                }
+
+                return list;
+            };
+
+            gui.set_root(make_list());
+            gui.set_root(make_list());
+
+            auto defs_ms      = 0.0;
+            auto reconcile_ms = 0.0;
+            auto allocations  = get_heap_allocation_count();
+
+            for(Uint rebuild = 0; rebuild < rebuild_count; rebuild += 1) {
+                auto start = Benchmark_Clock::now();
+                auto list = make_list();
+                defs_ms += get_milliseconds_since(start);
+
+                start = Benchmark_Clock::now();
+                gui.set_root(list);
+                reconcile_ms += get_milliseconds_since(start);
+            }
+
+            allocations = get_heap_allocation_count() - allocations;
+
+            printf(
+                "  %6zu children, %s: defs %9.3f us, reconcile %9.3f us (%.1f ns per child), "
+                "%.1f heap allocations per rebuild.\n",
+                child_count, *kind_name,
+                1000.0*defs_ms/Float64(rebuild_count),
+                1000.0*reconcile_ms/Float64(rebuild_count),
+                1000000.0*reconcile_ms/Float64(rebuild_count*child_count),
+                Float64(allocations)/Float64(rebuild_count)
+            );
+
+            gui.destroy();
+            kind_name += 1;
+        }
+    }
+}
+
+
+
+// Reordering 100k keyed rows: Unchanged, reversed, rotated by one and
+// shuffled.
+//  - Each starts from the rows in order.
+//  - The edit script's size is from the stack's Multi_Child_Widget::edits.
+//    Only the moves outside the longest run that kept its order are
+//    reported. (Reversed: n - 1, rotated: 1.)
+void run_reorder_benchmark() {
+    auto const row_count = Uint(100000);
+
+    printf("reordering %zu keyed rows:\n", row_count);
+
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+
+    auto make_rows = [&](const List<Uint>& order) {
+        auto list = gui.create_def<Stack_Def>();
+        list->axis = Axis::y;
+        list->children.reserve(row_count);
+
+        for(auto i : order) {
+            auto row = gui.create_def<Solid_Def>();
+            row->fill_color   = V4f { 0.29f, 0.56f, 0.89f, 1.0f };
+            row->stroke_color = V4f { 0.0f, 0.0f, 0.0f, 0.0f };
+            row->with_key(Key::from_uint(i));
+            list->children.push_back(row);
+        }
+
+        return list;
+    };
+
+    auto in_order = List<Uint>(row_count);
+    for(Uint i = 0; i < row_count; i += 1) {
+        in_order[i] = i;
+    }
+
+    auto reversed = List<Uint>(in_order.rbegin(), in_order.rend());
+
+    auto rotated = in_order;
+    std::rotate(rotated.begin(), rotated.begin() + 1, rotated.end());
+
+    auto shuffled = in_order;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1234));
+
+    gui.set_root(make_rows(in_order));
+
+    struct Case {
+        const char*       name;
+        const List<Uint>* order;
+    };
+
+    Case const cases[] = {
+        { "unchanged", &in_order },
+        { "reversed ", &reversed },
+        { "rotated  ", &rotated  },
+        { "shuffled ", &shuffled },
+    };
+
+    for(auto& reorder : cases) {
+        auto rows = make_rows(*reorder.order);
+
+        auto start = Benchmark_Clock::now();
+        gui.set_root(rows);
+        auto ms = get_milliseconds_since(start);
+
+        auto& edits = dynamic_cast<Stack_Widget*>(gui.root_widget)->edits;
+        printf(
+            "  %s: %.2f ms, %zu moves, %zu inserts, %zu removes.\n",
+            reorder.name, ms, edits.moves.size(), edits.inserts.size(), edits.removes.size()
+        );
+
+        gui.set_root(make_rows(in_order));
+    }
+
+    gui.destroy();
+}
+
+
+
+// fast_cast against dynamic_cast: The Widget_Def check reconcile_list
+// makes for every def.
+//  - 4k defs of four types (one of them a Widget_Def), cast 1000 times.
+//  - Both count the Widget_Defs, so the casts aren't optimized away.
+void run_fast_cast_benchmark() {
+    auto const def_count  = Uint(4096);
+    auto const pass_count = Uint(1000);
+
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+
+    auto widget = gui.create_widget<Solid_Widget>();
+
+    auto defs = List<Def*>();
+    for(Uint i = 0; i < def_count; i += 1) {
+        switch(i % 4) {
+            case 0: defs.push_back(gui.create_def<Solid_Def>()); break;
+            case 1: defs.push_back(gui.create_def<Padding_Def>()); break;
+            case 2: defs.push_back(gui.create_def<Stack_Def>()); break;
+            case 3: defs.push_back(gui.create_def<Widget_Def>(widget)); break;
+        }
+    }
+
+    auto time_casts = [&](auto cast, Uint* count) {
+        *count = 0;
+        auto start = Benchmark_Clock::now();
+        for(Uint pass = 0; pass < pass_count; pass += 1) {
+            for(auto def : defs) {
+                *count += cast(def) != nullptr;
+            }
+        }
+        return 1000000.0*get_milliseconds_since(start)/Float64(def_count*pass_count);
+    };
+
+    auto dynamic_count = Uint(0);
+    auto fast_count    = Uint(0);
+    auto dynamic_ns = time_casts([](Def* def) { return dynamic_cast<Widget_Def*>(def); }, &dynamic_count);
+    auto fast_ns    = time_casts([](Def* def) { return fast_cast<Widget_Def>(def); },     &fast_count);
+
+    printf(
+        "Def* -> Widget_Def*: dynamic_cast %.2f ns, fast_cast %.2f ns (%zu and %zu Widget_Defs).\n",
+        dynamic_ns, fast_ns, dynamic_count, fast_count
+    );
+
+    // The Gui owns the widget from here.
+    gui.set_root(gui.create_def<Widget_Def>(widget));
+    gui.destroy();
+}
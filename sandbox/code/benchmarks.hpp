@@ -0,0 +1,15 @@
+#pragma once
+
+
+// Headless benchmarks.
+//  - Portable: They only use the core, the library widgets and CPU_Backend.
+//  - Run by the sandbox's --benchmark mode.
+
+void run_incremental_layout_benchmark();
+void run_deep_tree_benchmark();
+void run_mouse_move_benchmark();
+void run_keyed_churn_benchmark();
+void run_key_benchmark();
+void run_reconcile_list_benchmark();
+void run_reorder_benchmark();
+void run_fast_cast_benchmark();
@@ -0,0 +1,16 @@
+#include "benchmarks.hpp"
+
+
+// The portable part of the sandbox's --benchmark mode, without a window
+// (eg: on a CI box).
+int main() {
+    run_incremental_layout_benchmark();
+    run_deep_tree_benchmark();
+    run_mouse_move_benchmark();
+    run_keyed_churn_benchmark();
+    run_key_benchmark();
+    run_reconcile_list_benchmark();
+    run_reorder_benchmark();
+    run_fast_cast_benchmark();
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include <cpp-gui/core/widget.hpp>
 #include <cpp-gui/core/gui.hpp>
 #include <cpp-gui/widgets/multi_child.hpp>
+#include <cpp-gui/widgets/stack.hpp>
 #include <cpp-gui/widgets/align.hpp>
 #include <cpp-gui/widgets/padding.hpp>
 #include <cpp-gui/widgets/text.hpp>
@@ -9,6 +10,14 @@
 #include <cpp-gui/widgets/solid.hpp>
 #include <cpp-gui/widgets/shadow.hpp>
 #include <cpp-gui/text.hpp>
+#include <cpp-gui/d2d_backend.hpp>
+#include <cpp-gui/cpu_backend.hpp>
+#include <cpp-gui/rounded_rect_kernel.hpp>
+
+#include <chrono>
+#include <cstring>
+
+#include "benchmarks.hpp"
 
 #pragma comment (lib, "User32.lib")
 #pragma comment (lib, "D2d1.lib")
@@ -17,65 +26,11 @@
 
 
 
-struct Stack_Def : virtual Multi_Child_Def {
-    // tbd: axis, direction, alignment.
-
-    virtual Widget* on_get_widget(Gui* gui) final override;
-};
-
-struct Stack_Widget : virtual Multi_Child_Widget {
-    // tbd: axis, direction, alignment.
-
-    virtual void on_layout(Box_Constraints constraints) final override;
-
-    virtual void match(const Stack_Def& def);
-    virtual Bool on_try_match(Def* def) final override;
-};
-
-
-Widget* Stack_Def::on_get_widget(Gui* gui) {
-    return gui->create_widget_and_match<Stack_Widget>(*this);
-}
-
-
-void Stack_Widget::on_layout(Box_Constraints constraints) {
-    auto cursor = V2f {};
-    auto max_height = 0.0f;
-    for(auto child : this->children) {
-        child->layout(constraints);
-        child->position = cursor;
-
-        cursor.x += child->size.x;
-        max_height = max(max_height, child->size.y);
-    }
-    this->size = { cursor.x, max_height };
-}
-
-void Stack_Widget::match(const Stack_Def& def) {
-    this->children = this->reconcile_list(this->children, def.children);
-
-    this->mark_for_layout();
-}
-
-Bool Stack_Widget::on_try_match(Def* def) {
-    return try_match_t<Stack_Def>(this, def);
-}
-
-
-
 struct Rect_Widget : public Widget {
     V4f color;
 
-    virtual void on_paint(ID2D1RenderTarget* target) final override {
-        auto brush = (ID2D1SolidColorBrush*)nullptr;
-        auto hr = target->CreateSolidColorBrush(to_d2d_colorf(this->color), &brush);
-        if(SUCCEEDED(hr)) {
-            target->FillRectangle(
-                D2D1::RectF(0, 0, this->size.x, this->size.y),
-                brush
-            );
-            brush->Release();
-        }
+    virtual void on_paint(Display_List* list) final override {
+        list->fill_rect(V2f { 0, 0 }, this->size, this->color);
     }
 };
 
@@ -92,7 +47,9 @@ struct Simple_Line_Edit : public Widget {
     virtual void on_create() final override;
     virtual ~Simple_Line_Edit();
 
-    virtual void on_paint(ID2D1RenderTarget* target) final override;
+    virtual void on_layout(Box_Constraints constraints) final override;
+
+    virtual void on_paint(Display_List* list) final override;
 
     virtual void on_key_down(Win32_Virtual_Key key) final override;
     virtual void on_char(Ascii_Char ch) final override;
@@ -106,22 +63,28 @@ void Simple_Line_Edit::update_text_widget() {
     def.color     = { 0, 0, 0, 1 };
 
     this->text_widget->match(def);
-    this->size     = this->text_widget->size;
-    this->baseline = this->text_widget->baseline;
-    // mark layout as changed.
 }
 
 void Simple_Line_Edit::on_create() {
     this->text_widget = gui->create_widget<Text_Widget>();
+    this->become_parent(this->text_widget);
     this->grab_keyboard_focus();
 }
 
 Simple_Line_Edit::~Simple_Line_Edit() {
-    safe_delete(&this->text_widget);
+    this->drop(this->text_widget);
+    this->text_widget = nullptr;
+}
+
+void Simple_Line_Edit::on_layout(Box_Constraints constraints) {
+    // Text_Widget::layout is the text layout.
+    this->text_widget->Widget::layout(constraints);
+    this->size     = this->text_widget->size;
+    this->baseline = this->text_widget->baseline;
 }
 
-void Simple_Line_Edit::on_paint(ID2D1RenderTarget* target) {
-    this->text_widget->paint(target);
+void Simple_Line_Edit::on_paint(Display_List* list) {
+    this->text_widget->paint(list);
 }
 
 void Simple_Line_Edit::on_key_down(Win32_Virtual_Key key) {
@@ -179,7 +142,7 @@ struct Simple_Button_Widget : virtual Base_Button_Widget, Rounded_Widget, Solid_
     virtual void on_press_begin() override;
     virtual void on_press_end() override;
 
-    virtual void on_paint(ID2D1RenderTarget* target) final override;
+    virtual void on_paint(Display_List* list) final override;
 };
 
 
@@ -237,7 +200,7 @@ void Simple_Button_Widget::on_press_end() {
 
 
 
-void Simple_Button_Widget::on_paint(ID2D1RenderTarget* target) {
+void Simple_Button_Widget::on_paint(Display_List* list) {
     auto scale = 1.0f;
     if(this->hovered()) { scale *= 1.1f; }
     if(this->pressed()) { scale *= 1.1f; }
@@ -245,15 +208,16 @@ void Simple_Button_Widget::on_paint(ID2D1RenderTarget* target) {
     this->fill_color   = V4f(scale * V3f(this->base_fill_color),   this->base_fill_color.a);
     this->stroke_color = V4f(scale * V3f(this->base_stroke_color), this->base_stroke_color.a);
 
-    Shadow_Widget::on_paint(target);
-    Solid_Widget::on_paint(target);
-    Single_Child_Widget::on_paint(target);
+    Shadow_Widget::on_paint(list);
+    Solid_Widget::on_paint(list);
+    Single_Child_Widget::on_paint(list);
 }
 
 
 
 ID2D1Factory*           d2d_factory;
 ID2D1HwndRenderTarget*  d2d_render_target;
+D2D_Backend             d2d_backend;
 
 IDWriteFactory* dwrite_factory;
 
@@ -269,9 +233,8 @@ void draw(V2f window_size) {
         assert(SUCCEEDED(hr));
     };
 
-    d2d_render_target->Clear(D2D1::ColorF(D2D1::ColorF::White));
-
-    gui.render_frame(window_size, d2d_render_target);
+    // Only the damage is repainted. The target keeps the rest.
+    gui.render_frame(window_size, &d2d_backend);
 }
 
 
@@ -286,24 +249,34 @@ LRESULT CALLBACK main_window_proc(HWND window, UINT message, WPARAM w_param, LPA
 
         auto hr = HRESULT {};
 
+        d2d_backend.release_device_resources();
         safe_release(&d2d_render_target);
 
         hr = d2d_factory->CreateHwndRenderTarget(
             D2D1::RenderTargetProperties(),
             D2D1::HwndRenderTargetProperties(
                 window,
-                D2D1::SizeU(rect.right - rect.left, rect.bottom - rect.top)
+                D2D1::SizeU(rect.right - rect.left, rect.bottom - rect.top),
+                D2D1_PRESENT_OPTIONS_RETAIN_CONTENTS
             ),
             &d2d_render_target
         );
         assert(SUCCEEDED(hr));
 
+        d2d_backend.target = d2d_render_target;
+        gui.damage_all();
+
         return 0;
     }
     else if(message == WM_PAINT) {
         auto rect = RECT {};
         GetClientRect(window, &rect);
 
+        // Not requested by the gui -> the system wants the window repainted.
+        if(gui.has_requested_frame == false) {
+            gui.damage_all();
+        }
+
         auto window_size = V2f { rect.right - rect.left, rect.bottom - rect.top };
         draw(window_size);
 
@@ -386,9 +359,152 @@ LRESULT CALLBACK main_window_proc(HWND window, UINT message, WPARAM w_param, LPA
 }
 
 
-int main() {
+// Blends fill and stroke spans of a rounded rect with each Rounded_Rect_Kernel
+// level the CPU supports.
+//  - 1024x1024 pixels. Every pixel goes through the kernel (CPU_Backend
+//    fills the inside with plain spans), so this is the worst case.
+void run_kernel_benchmark() {
+    auto const size      = Uint32(1024);
+    auto const rep_count = Uint(20);
+
+    auto pixels = List<Uint32>(size*size, 0xff202020);
+
+    auto kernel = Rounded_Rect_Kernel {};
+    kernel.fill_shape   = Rounded_Rect_Kernel::make_shape(V2f { 0, 0 }, V2f(Float32(size)), 200.0f);
+    kernel.fill_color   = 0xcc4080cc;
+    kernel.stroke_shape = Rounded_Rect_Kernel::make_shape(V2f(0.5f), V2f(Float32(size) - 0.5f), 200.0f);
+    kernel.stroke_color = 0xff204080;
+
+    printf("rounded rect kernel: %ux%u pixels, fill and stroke.\n", size, size);
+
+    auto supported = Rounded_Rect_Kernel::get_supported_level();
+    for(auto level : { Rounded_Rect_Kernel::Level::scalar, Rounded_Rect_Kernel::Level::sse2, Rounded_Rect_Kernel::Level::avx2 }) {
+        if(Uint32(level) > Uint32(supported)) {
+            break;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for(Uint rep = 0; rep < rep_count; rep += 1) {
+            for(Uint32 y = 0; y < size; y += 1) {
+                kernel.blend_span(level, &pixels[y*size], 0, Sint32(y), size);
+            }
+        }
+        auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+        auto mpix_per_second = Float64(size)*size*rep_count/duration.count()/1e6;
+        printf("  %s: %.1f Mpix/s\n", Rounded_Rect_Kernel::get_level_name(level), mpix_per_second);
+    }
+}
+
+// Renders about 10k widgets (rows of the demo's rects and buttons) with the
+// tiled CPU_Backend at 4K, for 1, 2, 4 and 8 threads.
+//  - Every frame repaints everything.
+//  - Text isn't painted (no glyph hook), but is laid out.
+void run_benchmark() {
+    auto const target_size = V2f { 3840, 2160 };
+    auto const group_count = Uint(1120);
+    auto const row_length  = Uint(32);
+    auto const frame_count = Uint(20);
+
+    auto bench_gui = Gui {};
+
+    auto make_button = [&](const char* string, V4f fill_color) {
+        auto button_text = bench_gui.create_def<Text_Def>();
+        button_text->string    = string;
+        button_text->font_face = &normal_font_face;
+        button_text->size      = 12.0f;
+        button_text->color     = V4f { 1, 1, 1, 1 };
+
+        auto padding = bench_gui.create_def<Padding_Def>();
+        padding->child   = button_text;
+        padding->pad_min = { 8, 4 };
+        padding->pad_max = { 8, 4 };
+
+        auto button = bench_gui.create_def<Simple_Button_Def>();
+        button->child         = padding;
+        button->corner_radius = 5.0f;
+        button->fill_color    = fill_color;
+        button->stroke_color  = 0.8f * fill_color;
+        return button;
+    };
+
+    auto rows = bench_gui.create_def<Stack_Def>();
+    rows->axis = Axis::y;
+
+    for(Uint i = 0; i < group_count; i += row_length) {
+        auto row = bench_gui.create_def<Stack_Def>();
+
+        for(Uint j = i; j < min(i + row_length, group_count); j += 1) {
+            auto left_rect = bench_gui.create_widget<Rect_Widget>();
+            left_rect->size  = { 20.0f, 15.0f };
+            left_rect->color = { 0.5f, 0.35f, 0.25f, 0.5f };
+
+            auto right_rect = bench_gui.create_widget<Rect_Widget>();
+            right_rect->size  = { 15.0f, 20.0f };
+            right_rect->color = { 0.8f, 0.9f, 0.35f, 0.2f };
+
+            auto group = bench_gui.create_def<Stack_Def>();
+            group->children = {
+                bench_gui.create_def<Widget_Def>(left_rect),
+                make_button("ok", V4f { 0.29f, 0.56f, 0.89f, 1.0f }),
+                bench_gui.create_def<Widget_Def>(right_rect),
+                make_button("no", V4f { 0.95f, 0.50f, 0.15f, 1.0f }),
+            };
+
+            row->children.push_back(group);
+        }
+
+        rows->children.push_back(row);
+    }
+
+    bench_gui.create(rows, []() {});
+
+    auto backend = CPU_Backend {};
+    backend.create(Uint32(target_size.x), Uint32(target_size.y));
+    backend.tiled = true;
+
+    // Lays out and creates the widgets.
+    bench_gui.render_frame(target_size, &backend);
+    auto widget_count = Uint(0);
+    for(auto pool : bench_gui.widget_pools) {
+        if(pool != nullptr) {
+            widget_count += pool->live_count;
+        }
+    }
+    printf("benchmark: %zu widgets, %zu painted.\n", widget_count, bench_gui.replayed_widget_count);
+
+    for(auto thread_count : { 1, 2, 4, 8 }) {
+        Thread_Pool pool;
+        pool.create(Uint(thread_count));
+        backend.thread_pool = &pool;
+
+        auto start = std::chrono::steady_clock::now();
+        for(Uint frame = 0; frame < frame_count; frame += 1) {
+            bench_gui.damage_all();
+            bench_gui.render_frame(target_size, &backend);
+        }
+        auto duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+        printf("  %d thread(s): %.2f ms/frame\n", thread_count, duration.count()/frame_count);
+
+        backend.thread_pool = nullptr;
+        pool.destroy();
+    }
+
+    bench_gui.destroy();
+    backend.destroy();
+
+    run_kernel_benchmark();
+}
+
+
+int main(int argc, char** argv) {
     HeapSetInformation(NULL, HeapEnableTerminationOnCorruption, NULL, 0);
 
+    // Deep widget trees are laid out on stack segments, which are fibers on
+    // Win32. Gui only uses them if the thread is a fiber.
+    ConvertThreadToFiber(nullptr);
+
     auto instance = GetModuleHandle(nullptr);
 
     auto window_class = WNDCLASSA {};
@@ -469,7 +585,21 @@ int main() {
     }
 
 
-    auto text = new Text_Def {};
+    if(argc > 1 && strcmp(argv[1], "--benchmark") == 0) {
+        run_benchmark();
+        run_incremental_layout_benchmark();
+        run_deep_tree_benchmark();
+        run_mouse_move_benchmark();
+        run_keyed_churn_benchmark();
+        run_key_benchmark();
+        run_reconcile_list_benchmark();
+        run_reorder_benchmark();
+        run_fast_cast_benchmark();
+        return 0;
+    }
+
+
+    auto text = gui.create_def<Text_Def>();
     text->string = "hello, there!";
     text->font_face = &normal_font_face;
     text->size = 48.0f;
@@ -486,15 +616,15 @@ int main() {
     auto text_edit = gui.create_widget<Simple_Line_Edit>();
     text_edit->font_face = &normal_font_face;
 
-    auto button = new Simple_Button_Def();
+    auto button = gui.create_def<Simple_Button_Def>();
     {
-        auto button_text = new Text_Def();
+        auto button_text = gui.create_def<Text_Def>();
         button_text->string = "Click me!";
         button_text->font_face = &normal_font_face;
         button_text->size = 16.0f;
         button_text->color = V4f { 1, 1, 1, 1 };
 
-        auto padding = new Padding_Def();
+        auto padding = gui.create_def<Padding_Def>();
         padding->child = button_text;
         padding->pad_min = { 14, 5 };
         padding->pad_max = { 14, 5 };
@@ -505,15 +635,15 @@ int main() {
         button->stroke_color = 0.8f * button->fill_color;
     }
 
-    auto other_button = new Simple_Button_Def();
+    auto other_button = gui.create_def<Simple_Button_Def>();
     {
-        auto button_text = new Text_Def();
+        auto button_text = gui.create_def<Text_Def>();
         button_text->string = "Me too!";
         button_text->font_face = &normal_font_face;
         button_text->size = 16.0f;
         button_text->color = V4f { 1, 1, 1, 1 };
 
-        auto padding = new Padding_Def();
+        auto padding = gui.create_def<Padding_Def>();
         padding->child = button_text;
         padding->pad_min = { 14, 5 };
         padding->pad_max = { 14, 5 };
@@ -526,28 +656,27 @@ int main() {
     auto spacer = gui.create_widget<Widget>();
     spacer->size.x = 50;
 
-    auto stack = new Stack_Def();
+    auto stack = gui.create_def<Stack_Def>();
     stack->children = {
-        new Widget_Def(left_rect),
-        text->with_key(new T_Key<Uint>(42)),
-        new Widget_Def(right_rect),
-        new Widget_Def(text_edit),
+        gui.create_def<Widget_Def>(left_rect),
+        text->with_key(Key::from_uint(42)),
+        gui.create_def<Widget_Def>(right_rect),
+        gui.create_def<Widget_Def>(text_edit),
         button,
-        new Widget_Def(spacer),
+        gui.create_def<Widget_Def>(spacer),
         other_button,
     };
 
-    auto align = new Align_Def {};
+    auto align = gui.create_def<Align_Def>();
     align->child = stack;
     align->align_point = { 0.5f, 0.5f };
 
     auto request_frame = [=]() { InvalidateRect(window, nullptr, false); };
     gui.create(align, request_frame);
-    delete align;
 
     #if 0
     {
-        auto text = new Text_Def {};
+        auto text = gui.create_def<Text_Def>();
         text->string = "hi";
         text->font_face = &normal_font_face;
         text->size = 48.0f;
@@ -557,21 +686,20 @@ int main() {
         middle_rect->size = { 100.0f, 100.0f };
         middle_rect->color = { 0.5f, 0.3f, 0.9, 0.5f };
 
-        auto stack = new Stack_Def();
+        auto stack = gui.create_def<Stack_Def>();
         stack->children = {
-            new Widget_Def(right_rect),
-            new Widget_Def(middle_rect),
-            text->with_key(new T_Key<Uint>(42)),
-            new Widget_Def(left_rect),
-            new Widget_Def(text_edit),
+            gui.create_def<Widget_Def>(right_rect),
+            gui.create_def<Widget_Def>(middle_rect),
+            text->with_key(Key::from_uint(42)),
+            gui.create_def<Widget_Def>(left_rect),
+            gui.create_def<Widget_Def>(text_edit),
         };
 
-        auto align = new Align_Def {};
+        auto align = gui.create_def<Align_Def>();
         align->child = stack;
         align->align_point = { 0.25f, 0.5f };
 
         gui.set_root(align);
-        delete align;
     }
     #endif
 
@@ -588,6 +716,7 @@ int main() {
     }
 
     gui.destroy();
+    d2d_backend.release_device_resources();
     printf("done.\n");
 
     return 0;
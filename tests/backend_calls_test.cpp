@@ -0,0 +1,245 @@
+#include <cpp-gui/core/gui.hpp>
+#include <cpp-gui/core/render_backend.hpp>
+#include <cpp-gui/widgets/padding.hpp>
+#include <cpp-gui/widgets/stack.hpp>
+
+#include "test.hpp"
+#include "test_widgets.hpp"
+
+
+// Backend calls made by replay: Translations are folded into the
+// primitives, culled widgets and undamaged frames make no calls.
+
+
+// Counts calls. Draws nothing.
+struct Counting_Backend : Render_Backend {
+    V2f             size      = { 200, 60 };
+    Paint_Transform transform = Paint_Transform::translation(V2f { 0, 0 });
+
+    Uint set_transform_count = 0;
+    Uint push_clip_count     = 0;
+    Uint clear_count         = 0;
+    Uint fill_count          = 0;
+    Uint stroke_count        = 0;
+    Uint solid_count         = 0;
+    Uint blurred_count       = 0;
+    Uint glyph_run_count     = 0;
+    Uint flush_count         = 0;
+
+    // The rects of the solid_rounded_rect calls, as passed.
+    List<Paint_Solid_Rounded_Rect> solid_rects;
+
+    void reset() {
+        auto size      = this->size;
+        auto transform = this->transform;
+        *this = Counting_Backend {};
+        this->size      = size;
+        this->transform = transform;
+    }
+
+    Uint get_primitive_count() {
+        return this->fill_count + this->stroke_count + this->solid_count
+            + this->blurred_count + this->glyph_run_count;
+    }
+
+
+    virtual V2f get_size() override { return this->size; }
+
+    virtual Paint_Transform get_transform() override { return this->transform; }
+
+    virtual void set_transform(const Paint_Transform& transform) override {
+        this->set_transform_count += 1;
+        this->transform = transform;
+    }
+
+    virtual void push_clip(Paint_Bounds bounds, Bool aliased) override {
+        UNUSED(bounds);
+        UNUSED(aliased);
+        this->push_clip_count += 1;
+    }
+
+    virtual void pop_clip() override {}
+
+    virtual void clear(V4f color) override {
+        UNUSED(color);
+        this->clear_count += 1;
+    }
+
+    virtual void fill_rounded_rect(const Paint_Rounded_Rect& rect) override {
+        UNUSED(rect);
+        this->fill_count += 1;
+    }
+
+    virtual void stroke_rounded_rect(const Paint_Rounded_Rect& rect) override {
+        UNUSED(rect);
+        this->stroke_count += 1;
+    }
+
+    virtual void solid_rounded_rect(const Paint_Solid_Rounded_Rect& rect) override {
+        this->solid_count += 1;
+        this->solid_rects.push_back(rect);
+    }
+
+    virtual void blurred_rounded_rect(const Paint_Blurred_Rounded_Rect& shadow) override {
+        UNUSED(shadow);
+        this->blurred_count += 1;
+    }
+
+    virtual void glyph_run(const Paint_Glyph_Run& run) override {
+        UNUSED(run);
+        this->glyph_run_count += 1;
+    }
+
+    virtual void flush() override {
+        this->flush_count += 1;
+    }
+};
+
+
+// A row of 20 cells, 20px wide. Each is a 10x10 card padded by 5px.
+struct Cell_Row {
+    Gui                gui;
+    List<Card_Widget*> cards;
+
+    void create() {
+        this->gui = Gui {};
+        this->gui.create(nullptr, []() {});
+        this->gui.synchronous_teardown = true;
+
+        auto stack = this->gui.create_def<Stack_Def>();
+        stack->axis = Axis::x;
+
+        for(Uint i = 0; i < 20; i += 1) {
+            auto card = this->gui.create_widget<Card_Widget>();
+            card->card_size  = V2f { 10, 10 };
+            card->fill_color   = V4f { 0.2f, 0.4f, 0.6f, 1.0f };
+            card->stroke_color = V4f { 0.0f, 0.0f, 0.0f, 0.0f };
+            this->cards.push_back(card);
+
+            auto padding = this->gui.create_def<Padding_Def>();
+            padding->child   = this->gui.create_def<Widget_Def>(card);
+            padding->pad_min = V2f { 5, 5 };
+            padding->pad_max = V2f { 5, 5 };
+            stack->children.push_back(padding);
+        }
+
+        this->gui.set_root(stack);
+    }
+
+    void destroy() {
+        this->gui.destroy();
+    }
+};
+
+
+static void test_translations() {
+    auto row = Cell_Row {};
+    row.create();
+
+    auto backend = Counting_Backend {};
+    row.gui.render_frame(backend.size, &backend);
+
+    // Only translations -> the target's transform is never set.
+    CHECK_EQUAL(backend.set_transform_count, Uint(0));
+
+    // The 10 cells in [0, 200). One solid rect and one shadow each.
+    CHECK_EQUAL(backend.solid_count,   Uint(10));
+    CHECK_EQUAL(backend.blurred_count, Uint(10));
+    CHECK_EQUAL(backend.get_primitive_count(), Uint(20));
+    CHECK_EQUAL(row.gui.culled_widget_count, Uint(10));
+
+    // Offset into target coordinates.
+    CHECK(backend.solid_rects.size() == 10 && backend.solid_rects[3].min == (V2f { 65, 5 }));
+    CHECK(backend.solid_rects.size() == 10 && backend.solid_rects[3].max == (V2f { 75, 15 }));
+
+    CHECK_EQUAL(backend.clear_count, Uint(1));
+    CHECK_EQUAL(backend.flush_count, Uint(1));
+
+    row.destroy();
+}
+
+static void test_damage() {
+    auto row = Cell_Row {};
+    row.create();
+
+    auto backend = Counting_Backend {};
+    row.gui.render_frame(backend.size, &backend);
+
+    // No damage -> nothing is painted.
+    backend.reset();
+    row.gui.render_frame(backend.size, &backend);
+    CHECK_EQUAL(backend.clear_count, Uint(0));
+    CHECK_EQUAL(backend.get_primitive_count(), Uint(0));
+    CHECK_EQUAL(backend.flush_count, Uint(1));
+
+    // One card changed -> only its cell is painted.
+    row.cards[3]->fill_color = V4f { 1, 0, 0, 1 };
+    row.cards[3]->mark_for_paint();
+
+    backend.reset();
+    row.gui.render_frame(backend.size, &backend);
+    CHECK_EQUAL(backend.clear_count,   Uint(1));
+    CHECK_EQUAL(backend.solid_count,   Uint(1));
+    CHECK_EQUAL(backend.blurred_count, Uint(1));
+    CHECK_EQUAL(backend.set_transform_count, Uint(0));
+
+    row.destroy();
+}
+
+
+// Paints a rect scaled by 2, then one without the scale.
+struct Scaled_Widget : virtual Widget {
+    virtual void on_layout(Box_Constraints constraints) override {
+        UNUSED(constraints);
+        this->size = V2f { 40, 40 };
+    }
+
+    virtual void on_paint(Display_List* list) override {
+        auto scale = Paint_Transform { V2f { 2, 0 }, V2f { 0, 2 }, V2f { 10, 0 } };
+        list->push_transform(scale);
+        list->solid_rounded_rect(V2f { 1, 1 }, V2f { 5, 5 }, 0.0f, V4f { 1, 1, 1, 1 }, V4f { 0, 0, 0, 0 });
+        list->solid_rounded_rect(V2f { 6, 1 }, V2f { 9, 5 }, 0.0f, V4f { 1, 1, 1, 1 }, V4f { 0, 0, 0, 0 });
+        list->pop_transform();
+
+        list->solid_rounded_rect(V2f { 1, 1 }, V2f { 5, 5 }, 0.0f, V4f { 1, 1, 1, 1 }, V4f { 0, 0, 0, 0 });
+    }
+};
+
+// The target's transform is set when the linear part changes. Not for every
+// widget or primitive.
+static void test_linear_transforms() {
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+
+    auto padding = gui.create_def<Padding_Def>();
+    padding->child   = gui.create_def<Widget_Def>(gui.create_widget<Scaled_Widget>());
+    padding->pad_min = V2f { 20, 10 };
+    gui.set_root(padding);
+
+    auto backend = Counting_Backend {};
+    gui.render_frame(backend.size, &backend);
+
+    // Into the scale, and back to the base transform.
+    CHECK_EQUAL(backend.set_transform_count, Uint(2));
+    CHECK(backend.transform.is_translation() && backend.transform.offset == (V2f { 0, 0 }));
+
+    // Scaled: Drawn in the widget's coordinates. Then offset by the
+    // widget's position.
+    CHECK_EQUAL(backend.solid_count, Uint(3));
+    if(backend.solid_rects.size() == 3) {
+        CHECK(backend.solid_rects[0].min == (V2f { 1, 1 }));
+        CHECK(backend.solid_rects[1].min == (V2f { 6, 1 }));
+        CHECK(backend.solid_rects[2].min == (V2f { 21, 11 }));
+    }
+
+    gui.destroy();
+}
+
+
+int main() {
+    test_translations();
+    test_damage();
+    test_linear_transforms();
+    return get_test_exit_code();
+}
@@ -0,0 +1,237 @@
+#include <limits>
+
+#include <cpp-gui/core/gui.hpp>
+#include <cpp-gui/widgets/padding.hpp>
+#include <cpp-gui/widgets/stack.hpp>
+#include <cpp-gui/cpu_backend.hpp>
+
+#include "test.hpp"
+#include "test_widgets.hpp"
+
+
+// Full frames (layout, paint, replay, damage) on CPU_Backend, without a
+// window or Direct2D.
+
+
+// Paints a glyph run at (5, 7). Text layouts need DirectWrite, so the run
+// has none. See glyph_hook.
+struct Glyph_Widget : virtual Widget {
+    virtual void on_layout(Box_Constraints constraints) override {
+        UNUSED(constraints);
+        this->size = V2f { 20, 10 };
+    }
+
+    virtual void on_paint(Display_List* list) override {
+        list->glyph_run(nullptr, V2f { 5, 7 }, V4f { 0, 0, 0, 1 });
+    }
+};
+
+
+struct Scene {
+    Gui           gui;
+    Card_Widget*  cards[3];
+    Glyph_Widget* glyphs;
+
+    void create() {
+        this->gui = Gui {};
+        this->gui.create(nullptr, []() {});
+        this->gui.synchronous_teardown = true;
+
+        auto stack = this->gui.create_def<Stack_Def>();
+
+        auto const fill_colors = {
+            V4f { 0.2f, 0.4f, 0.6f, 1.0f },
+            V4f { 0.9f, 0.5f, 0.1f, 1.0f },
+            V4f { 0.3f, 0.8f, 0.3f, 0.5f },
+        };
+
+        auto index = Uint(0);
+        for(auto fill_color : fill_colors) {
+            auto card = this->gui.create_widget<Card_Widget>();
+            card->card_size     = V2f { 40, 30 };
+            card->corner_radius = 6.0f;
+            card->fill_color    = fill_color;
+            card->stroke_color  = V4f { 0.0f, 0.0f, 0.0f, 0.5f };
+            this->cards[index] = card;
+            index += 1;
+
+            stack->children.push_back(this->gui.create_def<Widget_Def>(card));
+        }
+
+        this->glyphs = this->gui.create_widget<Glyph_Widget>();
+        stack->children.push_back(this->gui.create_def<Widget_Def>(this->glyphs));
+
+        auto padding = this->gui.create_def<Padding_Def>();
+        padding->child   = stack;
+        padding->pad_min = V2f { 10, 10 };
+        padding->pad_max = V2f { 10, 10 };
+
+        this->gui.set_root(padding);
+    }
+
+    void destroy() {
+        this->gui.destroy();
+    }
+};
+
+
+static Uint glyph_run_count = 0;
+
+// Blends a 2x2 block at each glyph run.
+static void paint_glyph_run(CPU_Backend* backend, const Paint_Glyph_Run& run) {
+    glyph_run_count += 1;
+
+    Uint8 const mask[4] = { 255, 255, 255, 255 };
+    backend->blend_mask(Sint32(run.position.x), Sint32(run.position.y), 2, 2, mask, 2, run.color);
+}
+
+static void create_backend(CPU_Backend* backend, Bool tiled, Thread_Pool* thread_pool) {
+    backend->create(200, 60);
+    backend->tiled       = tiled;
+    backend->thread_pool = thread_pool;
+    backend->glyph_hook  = paint_glyph_run;
+}
+
+static Bool have_same_pixels(const CPU_Backend& a, const CPU_Backend& b) {
+    return a.width == b.width && a.height == b.height && a.pixels == b.pixels;
+}
+
+
+static void test_full_frame() {
+    auto scene = Scene {};
+    scene.create();
+
+    auto backend = CPU_Backend {};
+    create_backend(&backend, false, nullptr);
+
+    glyph_run_count = 0;
+    auto& damage = scene.gui.render_frame(V2f { 200, 60 }, &backend);
+
+    // First frame: Everything.
+    CHECK_EQUAL(damage.size(), Uint(1));
+    CHECK_EQUAL(scene.gui.replayed_widget_count, Uint(6));
+
+    // Background (clear_color).
+    CHECK_EQUAL(backend.get_pixel(0, 0),    Uint32(0xffffffff));
+    CHECK_EQUAL(backend.get_pixel(199, 59), Uint32(0xffffffff));
+
+    // Card centers: Opaque fills are exact. Cards start at (10, 10).
+    CHECK_EQUAL(backend.get_pixel(30, 25), Uint32(0xff996633));
+    CHECK_EQUAL(backend.get_pixel(70, 25), Uint32(0xff1a80e6));
+
+    // The shadow is below the cards (offset 2, blur 3).
+    auto shadow = backend.get_pixel(30, 41);
+    CHECK(shadow != 0xffffffff);
+    CHECK((shadow >> 24) == 0xff);
+
+    // Glyph run at (130 + 5, 10 + 7).
+    CHECK_EQUAL(glyph_run_count, Uint(1));
+    CHECK_EQUAL(backend.get_pixel(135, 17), Uint32(0xff000000));
+    CHECK_EQUAL(backend.get_pixel(136, 18), Uint32(0xff000000));
+
+    backend.destroy();
+    scene.destroy();
+}
+
+// Tiled mode produces the same bytes as immediate mode, for any thread count.
+static void test_tiled_frames() {
+    auto scene = Scene {};
+    scene.create();
+
+    auto immediate = CPU_Backend {};
+    create_backend(&immediate, false, nullptr);
+    scene.gui.render_frame(V2f { 200, 60 }, &immediate);
+
+    for(auto thread_count : { 0, 1, 4 }) {
+        Thread_Pool pool;
+        if(thread_count > 0) {
+            pool.create(Uint(thread_count));
+        }
+
+        auto tiled = CPU_Backend {};
+        create_backend(&tiled, true, thread_count > 0 ? &pool : nullptr);
+        tiled.tile_size = 16;
+
+        scene.gui.damage_all();
+        scene.gui.render_frame(V2f { 200, 60 }, &tiled);
+        CHECK(have_same_pixels(tiled, immediate));
+
+        tiled.destroy();
+        if(thread_count > 0) {
+            pool.destroy();
+        }
+    }
+
+    immediate.destroy();
+    scene.destroy();
+}
+
+// Repainting only the damage matches repainting everything.
+static void test_damage_frames() {
+    auto scene = Scene {};
+    scene.create();
+
+    auto backend = CPU_Backend {};
+    create_backend(&backend, false, nullptr);
+    scene.gui.render_frame(V2f { 200, 60 }, &backend);
+
+    auto card = scene.cards[1];
+    card->fill_color = V4f { 0.1f, 0.1f, 0.7f, 1.0f };
+    card->mark_for_paint();
+
+    auto& damage = scene.gui.render_frame(V2f { 200, 60 }, &backend);
+    CHECK_EQUAL(damage.size(), Uint(1));
+    CHECK_EQUAL(backend.get_pixel(70, 25), Uint32(0xffb31a1a));
+
+    // Outside the card and its shadow: Not repainted.
+    CHECK(damage.size() == 1 && damage[0].min.x >= 40.0f && damage[0].max.x <= 100.0f);
+
+    auto reference = CPU_Backend {};
+    create_backend(&reference, false, nullptr);
+    scene.gui.damage_all();
+    scene.gui.render_frame(V2f { 200, 60 }, &reference);
+
+    CHECK(have_same_pixels(backend, reference));
+
+    reference.destroy();
+    backend.destroy();
+    scene.destroy();
+}
+
+// Huge and non-finite rects (like an unconstrained size) are clamped or
+// skipped, not converted to pixels as is.
+static void test_degenerate_rects() {
+    auto backend = CPU_Backend {};
+    create_backend(&backend, false, nullptr);
+    backend.clear(V4f { 1, 1, 1, 1 });
+
+    auto const nan      = std::numeric_limits<Float32>::quiet_NaN();
+    auto const infinity = std::numeric_limits<Float32>::infinity();
+    auto const red      = V4f { 1, 0, 0, 1 };
+
+    // NaN and infinite edges: Skipped.
+    backend.solid_rounded_rect({ V2f { nan, 0 }, V2f { 20, 20 }, 0.0f, red, red });
+    backend.fill_rounded_rect({ V2f { 0, 0 }, V2f { infinity, 20 }, 0.0f, red });
+    backend.stroke_rounded_rect({ V2f { -infinity, 0 }, V2f { 20, nan }, 0.0f, red });
+    CHECK_EQUAL(backend.get_pixel(10, 10), Uint32(0xffffffff));
+
+    // Huge: Fills the clip, which is huge too (in x).
+    backend.push_clip(Paint_Bounds { V2f { -1e30f, 10 }, V2f { 1e30f, 60 } }, false);
+    backend.fill_rounded_rect({ V2f { -1e30f, -1e30f }, V2f { 1e30f, 1e30f }, 4.0f, red });
+    backend.pop_clip();
+
+    CHECK_EQUAL(backend.get_pixel(0, 9),    Uint32(0xffffffff));
+    CHECK_EQUAL(backend.get_pixel(0, 10),   Uint32(0xff0000ff));
+    CHECK_EQUAL(backend.get_pixel(199, 59), Uint32(0xff0000ff));
+
+    backend.destroy();
+}
+
+
+int main() {
+    test_full_frame();
+    test_tiled_frames();
+    test_damage_frames();
+    test_degenerate_rects();
+    return get_test_exit_code();
+}
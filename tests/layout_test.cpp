@@ -0,0 +1,205 @@
+#include <cpp-gui/core/gui.hpp>
+#include <cpp-gui/widgets/padding.hpp>
+#include <cpp-gui/widgets/stack.hpp>
+
+#include "test.hpp"
+
+
+// Incremental layout: Only dirty widgets and their ancestors (up to a
+// relayout boundary) run on_layout.
+
+
+// Counts on_layout calls.
+struct Counted_Widget : virtual Widget {
+    static Uint layout_count;
+
+    V2f fixed_size = { 8, 8 };
+
+    virtual void on_layout(Box_Constraints constraints) override {
+        UNUSED(constraints);
+        layout_count += 1;
+        this->size = this->fixed_size;
+    }
+};
+
+Uint Counted_Widget::layout_count = 0;
+
+// Marks `target` for layout in its next on_layout.
+struct Marking_Widget : virtual Widget {
+    Widget* target = nullptr;
+
+    virtual void on_layout(Box_Constraints constraints) override {
+        UNUSED(constraints);
+        this->size = V2f { 8, 8 };
+
+        if(this->target != nullptr) {
+            this->target->mark_for_layout();
+            this->target = nullptr;
+        }
+    }
+};
+
+
+static const Box_Constraints loose = { V2f { 0, 0 }, V2f { 1000, 1000 } };
+
+static void lay_out(Gui* gui, Box_Constraints constraints) {
+    gui->root_widget->layout(constraints);
+    gui->flush_layout_queue();
+}
+
+
+// A dirty widget next to a clean list.
+static void test_clean_subtrees() {
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+
+    auto hot = gui.create_widget<Counted_Widget>();
+
+    auto clean = gui.create_def<Stack_Def>();
+    clean->axis = Axis::y;
+    for(Uint i = 0; i < 100; i += 1) {
+        clean->children.push_back(gui.create_def<Widget_Def>(gui.create_widget<Counted_Widget>()));
+    }
+
+    auto root = gui.create_def<Stack_Def>();
+    root->axis = Axis::y;
+    root->children.push_back(gui.create_def<Widget_Def>(hot));
+    root->children.push_back(clean);
+    gui.set_root(root);
+
+    Counted_Widget::layout_count = 0;
+    lay_out(&gui, loose);
+    CHECK_EQUAL(Counted_Widget::layout_count, Uint(101));
+
+    // Nothing changed.
+    Counted_Widget::layout_count = 0;
+    lay_out(&gui, loose);
+    CHECK_EQUAL(Counted_Widget::layout_count, Uint(0));
+
+    // The hot widget grows: Only it is laid out. The list moves down.
+    hot->fixed_size = V2f { 8, 20 };
+    hot->mark_for_layout();
+    CHECK(gui.root_widget->needs_layout);
+
+    Counted_Widget::layout_count = 0;
+    lay_out(&gui, loose);
+    CHECK_EQUAL(Counted_Widget::layout_count, Uint(1));
+    CHECK(gui.root_widget->size.y == 20.0f + 100*8.0f);
+
+    // New constraints: Everything.
+    Counted_Widget::layout_count = 0;
+    lay_out(&gui, Box_Constraints { V2f { 0, 0 }, V2f { 500, 1000 } });
+    CHECK_EQUAL(Counted_Widget::layout_count, Uint(101));
+
+    gui.destroy();
+}
+
+// Widgets with tight constraints are relayout boundaries: They are queued,
+// their ancestors aren't marked.
+static void test_relayout_boundaries() {
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+
+    auto leaf = gui.create_widget<Counted_Widget>();
+
+    auto padding = gui.create_def<Padding_Def>();
+    padding->child   = gui.create_def<Widget_Def>(leaf);
+    padding->pad_min = V2f { 1, 1 };
+    padding->pad_max = V2f { 1, 1 };
+    gui.set_root(padding);
+
+    lay_out(&gui, Box_Constraints::tight(V2f { 100, 100 }));
+    CHECK(leaf->is_relayout_boundary());
+
+    leaf->mark_for_layout();
+    CHECK(leaf->in_layout_queue);
+    CHECK(gui.root_widget->needs_layout == false);
+
+    Counted_Widget::layout_count = 0;
+    gui.flush_layout_queue();
+    CHECK_EQUAL(Counted_Widget::layout_count, Uint(1));
+    CHECK(leaf->needs_layout == false);
+
+    gui.destroy();
+}
+
+// A mark during an ancestor's layout, on a widget that was already laid
+// out: The ancestor's mark was cleared when it started, so the mark queues
+// the root and isn't lost.
+static void test_mark_during_layout() {
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+
+    auto first  = gui.create_widget<Counted_Widget>();
+    auto second = gui.create_widget<Marking_Widget>();
+
+    auto root = gui.create_def<Stack_Def>();
+    root->axis = Axis::y;
+    root->children.push_back(gui.create_def<Widget_Def>(first));
+    root->children.push_back(gui.create_def<Widget_Def>(second));
+    gui.set_root(root);
+
+    lay_out(&gui, loose);
+
+    // The stack skips `first` (clean) and lays out `second`, which marks
+    // `first`. The root is laid out again by flush_layout_queue.
+    first->fixed_size = V2f { 8, 20 };
+    second->target = first;
+    second->mark_for_layout();
+
+    Counted_Widget::layout_count = 0;
+    lay_out(&gui, loose);
+    CHECK_EQUAL(Counted_Widget::layout_count, Uint(1));
+    CHECK(first->needs_layout == false);
+    CHECK(gui.root_widget->needs_layout == false);
+    CHECK(gui.root_widget->size.y == 28.0f);
+
+    gui.destroy();
+}
+
+// Marking a widget twice between layouts only walks up once. The second
+// mark stops at the widget itself.
+static void test_repeated_marks() {
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+
+    auto leaf = gui.create_widget<Counted_Widget>();
+
+    auto padding = gui.create_def<Padding_Def>();
+    padding->child = gui.create_def<Widget_Def>(leaf);
+    gui.set_root(padding);
+
+    lay_out(&gui, loose);
+
+    leaf->mark_for_layout();
+    CHECK(gui.root_widget->needs_layout);
+    CHECK(gui.root_widget->in_layout_queue);
+
+    // Still consistent: Nothing was laid out in between.
+    gui.unqueue_layout(gui.root_widget);
+    leaf->mark_for_layout();
+    CHECK(gui.root_widget->in_layout_queue == false);
+
+    // After a layout, marks walk up again.
+    gui.queue_layout(gui.root_widget);
+    lay_out(&gui, loose);
+    CHECK(leaf->needs_layout == false);
+
+    leaf->mark_for_layout();
+    CHECK(gui.root_widget->in_layout_queue);
+
+    gui.destroy();
+}
+
+
+int main() {
+    test_clean_subtrees();
+    test_relayout_boundaries();
+    test_mark_during_layout();
+    test_repeated_marks();
+    return get_test_exit_code();
+}
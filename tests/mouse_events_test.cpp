@@ -0,0 +1,294 @@
+#include <string>
+
+#include <cpp-gui/core/gui.hpp>
+#include <cpp-gui/widgets/multi_child.hpp>
+
+#include "test.hpp"
+
+
+// Order of the mouse enter/leave events. See Widget's "Receiving mouse
+// events".
+
+
+// Log of events: "A+ " for enter, "A- " for leave.
+static std::string event_log;
+
+#define CHECK_EVENTS(expected) \
+    do { \
+        CHECK(event_log == expected); \
+        if(event_log != expected) { \
+            printf("  events: \"%s\"\n", event_log.c_str()); \
+        } \
+        event_log.clear(); \
+    } while(0)
+
+
+// A rect at a fixed position in its parent that logs enter/leave events.
+struct Hover_Def : virtual Multi_Child_Def {
+    const char* name        = "";
+    V2f         rect_min    = { 0, 0 };
+    V2f         rect_size   = { 0, 0 };
+    Bool        takes_input = true;
+
+    virtual Widget* on_get_widget(Gui* gui) override;
+};
+
+struct Hover_Widget : virtual Multi_Child_Widget {
+    // Grabs the mouse focus in on_mouse_enter.
+    static Hover_Widget* grab_on_enter;
+
+    const char* name;
+    V2f         rect_min;
+    V2f         rect_size;
+    Bool        takes_input;
+
+    virtual void match(const Hover_Def& def) {
+        Multi_Child_Widget::match(def);
+        this->name        = def.name;
+        this->rect_min    = def.rect_min;
+        this->rect_size   = def.rect_size;
+        this->takes_input = def.takes_input;
+        this->mark_for_layout();
+    }
+
+    virtual Bool on_try_match(Def* def) override {
+        return try_match_t<Hover_Def>(this, def);
+    }
+
+    virtual void on_layout(Box_Constraints constraints) override {
+        this->size = this->rect_size;
+
+        for(auto child : this->children) {
+            child->layout(constraints);
+            child->position = dynamic_cast<Hover_Widget*>(child)->rect_min;
+        }
+    }
+
+    virtual Bool takes_mouse_input() override {
+        return this->takes_input;
+    }
+
+    virtual void on_mouse_enter() override {
+        event_log += this->name;
+        event_log += "+ ";
+
+        if(this == grab_on_enter) {
+            this->grab_mouse_focus();
+        }
+    }
+
+    virtual void on_mouse_leave() override {
+        event_log += this->name;
+        event_log += "- ";
+    }
+};
+
+Hover_Widget* Hover_Widget::grab_on_enter = nullptr;
+
+Widget* Hover_Def::on_get_widget(Gui* gui) {
+    return gui->create_widget_and_match<Hover_Widget>(*this);
+}
+
+
+static Hover_Def* make_hover(Gui* gui, const char* name, V2f rect_min, V2f rect_size) {
+    auto def = gui->create_def<Hover_Def>();
+    def->name      = name;
+    def->rect_min  = rect_min;
+    def->rect_size = rect_size;
+    def->with_key(Key::make(Key_Type::uint, Uint64(name[0])));
+    return def;
+}
+
+static Hover_Def* make_root(Gui* gui) {
+    auto root = make_hover(gui, "R", V2f { 0, 0 }, V2f { 200, 100 });
+    root->takes_input = false;
+    return root;
+}
+
+static void lay_out(Gui* gui) {
+    gui->root_widget->layout(Box_Constraints::tight(V2f { 200, 100 }));
+    gui->flush_layout_queue();
+}
+
+static Hover_Widget* find(Gui* gui, const char* name) {
+    auto result = (Hover_Widget*)nullptr;
+
+    auto visit = [&](Hover_Widget* widget, auto& visit) -> void {
+        if(widget->name[0] == name[0]) {
+            result = widget;
+        }
+        for(auto child : widget->children) {
+            visit(dynamic_cast<Hover_Widget*>(child), visit);
+        }
+    };
+    visit(dynamic_cast<Hover_Widget*>(gui->root_widget), visit);
+
+    return result;
+}
+
+static std::string get_hot_names(Gui* gui) {
+    auto names = std::string();
+    for(auto widget : gui->mouse.hot_list) {
+        names += dynamic_cast<Hover_Widget*>(widget)->name;
+    }
+    return names;
+}
+
+
+// A (with C inside) and B, side by side.
+static void create_nested(Gui* gui) {
+    auto a = make_hover(gui, "A", V2f {   0, 0 }, V2f { 100, 100 });
+    auto b = make_hover(gui, "B", V2f { 100, 0 }, V2f { 100, 100 });
+    auto c = make_hover(gui, "C", V2f {  25, 25 }, V2f {  50,  50 });
+    a->children.push_back(c);
+
+    auto root = make_root(gui);
+    root->children.push_back(a);
+    root->children.push_back(b);
+
+    gui->set_root(root);
+    lay_out(gui);
+}
+
+// Enter events are back-to-front. Leave events come first, also
+// back-to-front.
+static void test_enter_leave_order() {
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+    create_nested(&gui);
+
+    gui.on_mouse_move(V2f { 50, 50 });
+    CHECK_EVENTS("A+ C+ ");
+    CHECK(get_hot_names(&gui) == "AC");
+
+    // Still in A.
+    gui.on_mouse_move(V2f { 10, 10 });
+    CHECK_EVENTS("C- ");
+
+    gui.on_mouse_move(V2f { 50, 50 });
+    CHECK_EVENTS("C+ ");
+
+    // Moving to B: A and C leave before B enters.
+    gui.on_mouse_move(V2f { 150, 50 });
+    CHECK_EVENTS("A- C- B+ ");
+    CHECK(get_hot_names(&gui) == "B");
+
+    // And back: B leaves before A and C enter.
+    gui.on_mouse_move(V2f { 40, 40 });
+    CHECK_EVENTS("B- A+ C+ ");
+
+    // No move -> no events.
+    gui.on_mouse_move(V2f { 40, 40 });
+    gui.update_mouse();
+    CHECK_EVENTS("");
+
+    gui.on_mouse_leave();
+    CHECK_EVENTS("A- C- ");
+    CHECK(gui.mouse.hot_list.empty());
+
+    gui.destroy();
+}
+
+// Swapping hot widgets: Widgets in both lists get no events. The hot list
+// follows the new back-to-front order.
+static void test_hot_list_swaps() {
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+
+    // P and Q overlap. The later sibling is in front.
+    auto build = [&](Bool q_in_front) {
+        auto p = make_hover(&gui, "P", V2f { 0, 0 }, V2f { 100, 100 });
+        auto q = make_hover(&gui, "Q", V2f { 0, 0 }, V2f { 100, 100 });
+
+        auto root = make_root(&gui);
+        root->children.push_back(q_in_front ? (Def*)p : (Def*)q);
+        root->children.push_back(q_in_front ? (Def*)q : (Def*)p);
+
+        gui.set_root(root);
+        lay_out(&gui);
+    };
+
+    build(true);
+    gui.on_mouse_move(V2f { 50, 50 });
+    CHECK_EVENTS("P+ Q+ ");
+    CHECK(get_hot_names(&gui) == "PQ");
+
+    auto p = find(&gui, "P");
+    auto q = find(&gui, "Q");
+
+    // Reordered (keyed -> same widgets).
+    build(false);
+    CHECK(find(&gui, "P") == p && find(&gui, "Q") == q);
+
+    gui.update_mouse();
+    CHECK_EVENTS("");
+    CHECK(get_hot_names(&gui) == "QP");
+
+    // The focus widget filters the hot list.
+    p->grab_mouse_focus();
+    CHECK_EVENTS("Q- ");
+    CHECK(get_hot_names(&gui) == "P");
+
+    p->release_mouse_focus();
+    CHECK_EVENTS("Q+ ");
+    CHECK(get_hot_names(&gui) == "QP");
+
+    // Replace Q with S: Q is destroyed while hot.
+    auto root = make_root(&gui);
+    root->children.push_back(make_hover(&gui, "P", V2f { 0, 0 }, V2f { 100, 100 }));
+    root->children.push_back(make_hover(&gui, "S", V2f { 0, 0 }, V2f { 100, 100 }));
+    gui.set_root(root);
+    lay_out(&gui);
+
+    // It left the list without an event.
+    CHECK(get_hot_names(&gui) == "P");
+
+    gui.update_mouse();
+    CHECK_EVENTS("S+ ");
+    CHECK(get_hot_names(&gui) == "PS");
+
+    gui.on_mouse_leave();
+    CHECK_EVENTS("P- S- ");
+
+    gui.destroy();
+}
+
+// A handler grabs the mouse focus during the enter events: The update it
+// triggers runs after the outer one. (Not inside it, while the hot lists
+// are being iterated.)
+static void test_focus_in_handler() {
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+    create_nested(&gui);
+
+    auto a = find(&gui, "A");
+    Hover_Widget::grab_on_enter = a;
+
+    // A grabs the focus. C enters with A, then leaves in the queued update.
+    gui.on_mouse_move(V2f { 50, 50 });
+    CHECK_EVENTS("A+ C+ C- ");
+    CHECK(get_hot_names(&gui) == "A");
+    CHECK(gui.get_mouse_focus() == a);
+
+    Hover_Widget::grab_on_enter = nullptr;
+
+    a->release_mouse_focus();
+    CHECK_EVENTS("C+ ");
+    CHECK(get_hot_names(&gui) == "AC");
+
+    gui.on_mouse_leave();
+    CHECK_EVENTS("A- C- ");
+
+    gui.destroy();
+}
+
+
+int main() {
+    test_enter_leave_order();
+    test_hot_list_swaps();
+    test_focus_in_handler();
+    return get_test_exit_code();
+}
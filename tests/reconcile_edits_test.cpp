@@ -0,0 +1,93 @@
+#include <cpp-gui/core/gui.hpp>
+#include <cpp-gui/widgets/solid.hpp>
+#include <cpp-gui/widgets/stack.hpp>
+
+#include "test.hpp"
+
+
+// Edit scripts of reconcile_list: Only the widgets outside the longest run
+// that kept its order are moves.
+
+
+static Stack_Def* make_rows(Gui* gui, const List<Uint>& keys) {
+    auto list = gui->create_def<Stack_Def>();
+    list->axis = Axis::y;
+
+    for(auto key : keys) {
+        auto row = gui->create_def<Solid_Def>();
+        row->fill_color   = V4f { 1, 1, 1, 1 };
+        row->stroke_color = V4f { 0, 0, 0, 0 };
+        row->with_key(Key::from_uint(key));
+        list->children.push_back(row);
+    }
+
+    return list;
+}
+
+static Reconcile_Edits& get_edits(Gui* gui) {
+    return dynamic_cast<Stack_Widget*>(gui->root_widget)->edits;
+}
+
+
+static void test_reorders() {
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+
+    auto in_order = List<Uint> { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    gui.set_root(make_rows(&gui, in_order));
+
+    auto old_children = dynamic_cast<Stack_Widget*>(gui.root_widget)->children;
+
+    // Unchanged: No edits.
+    gui.set_root(make_rows(&gui, in_order));
+    CHECK(get_edits(&gui).empty());
+
+    // Reversed: All but one move.
+    gui.set_root(make_rows(&gui, List<Uint> { 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 }));
+    CHECK_EQUAL(get_edits(&gui).moves.size(), Uint(9));
+    CHECK_EQUAL(get_edits(&gui).inserts.size(), Uint(0));
+    CHECK_EQUAL(get_edits(&gui).removes.size(), Uint(0));
+
+    // The widgets were reused.
+    auto& children = dynamic_cast<Stack_Widget*>(gui.root_widget)->children;
+    CHECK(children.size() == 10 && children[0] == old_children[9] && children[9] == old_children[0]);
+
+    gui.set_root(make_rows(&gui, in_order));
+
+    // Rotated by one: The first row moves to the end.
+    gui.set_root(make_rows(&gui, List<Uint> { 1, 2, 3, 4, 5, 6, 7, 8, 9, 0 }));
+    auto& edits = get_edits(&gui);
+    CHECK_EQUAL(edits.moves.size(), Uint(1));
+    if(edits.moves.size() == 1) {
+        CHECK_EQUAL(edits.moves[0].old_index, Uint32(0));
+        CHECK_EQUAL(edits.moves[0].new_index, Uint32(9));
+    }
+
+    gui.destroy();
+}
+
+static void test_inserts_and_removes() {
+    auto gui = Gui {};
+    gui.create(nullptr, []() {});
+    gui.synchronous_teardown = true;
+
+    gui.set_root(make_rows(&gui, List<Uint> { 0, 1, 2, 3 }));
+
+    // 1 and 3 removed, 7 and 8 inserted. 0 and 2 keep their order.
+    gui.set_root(make_rows(&gui, List<Uint> { 7, 0, 2, 8 }));
+
+    auto& edits = get_edits(&gui);
+    CHECK_EQUAL(edits.moves.size(), Uint(0));
+    CHECK(edits.inserts == (List<Uint32> { 0, 3 }));
+    CHECK(edits.removes == (List<Uint32> { 1, 3 }));
+
+    gui.destroy();
+}
+
+
+int main() {
+    test_reorders();
+    test_inserts_and_removes();
+    return get_test_exit_code();
+}
@@ -0,0 +1,227 @@
+#include <cpp-gui/core/gui.hpp>
+#include <cpp-gui/widgets/stack.hpp>
+#include <cpp-gui/cpu_backend.hpp>
+
+#include "test.hpp"
+#include "test_widgets.hpp"
+
+
+// Replay culls the children of stacks by their offsets, without testing the
+// bounds of every child.
+
+
+struct Card_Row {
+    Gui                gui;
+    Stack_Widget*      stack;
+    List<Card_Widget*> cards;
+
+    void create(Uint count, V2f card_size, Direction direction) {
+        this->gui = Gui {};
+        this->gui.create(nullptr, []() {});
+        this->gui.synchronous_teardown = true;
+
+        auto def = this->gui.create_def<Stack_Def>();
+        def->axis      = Axis::x;
+        def->direction = direction;
+
+        for(Uint i = 0; i < count; i += 1) {
+            auto card = this->gui.create_widget<Card_Widget>();
+            card->card_size  = card_size;
+            card->fill_color   = V4f { 0.2f, 0.4f, 0.6f, 0.5f };
+            card->stroke_color = V4f { 0.0f, 0.0f, 0.0f, 0.0f };
+            this->cards.push_back(card);
+
+            def->children.push_back(this->gui.create_def<Widget_Def>(card));
+        }
+
+        this->gui.set_root(def);
+        this->stack = dynamic_cast<Stack_Widget*>(this->gui.root_widget);
+    }
+
+    Uint get_paint_bounds_count() {
+        auto count = Uint(0);
+        for(auto card : this->cards) {
+            count += card->paint_bounds_count;
+            card->paint_bounds_count = 0;
+        }
+        return count;
+    }
+
+    void destroy() {
+        this->gui.destroy();
+    }
+};
+
+static void create_backend(CPU_Backend* backend) {
+    backend->create(200, 60);
+}
+
+
+static void test_children_in_range() {
+    auto row = Card_Row {};
+    row.create(10, V2f { 10, 10 }, Direction::min);
+
+    auto backend = CPU_Backend {};
+    create_backend(&backend);
+    row.gui.render_frame(V2f { 200, 60 }, &backend);
+
+    auto range = row.stack->get_children_in_range(15.0f, 35.0f);
+    CHECK_EQUAL(range._begin, Uint(1));
+    CHECK_EQUAL(range._end,   Uint(4));
+
+    // Touching edges don't overlap.
+    range = row.stack->get_children_in_range(10.0f, 20.0f);
+    CHECK_EQUAL(range._begin, Uint(1));
+    CHECK_EQUAL(range._end,   Uint(2));
+
+    range = row.stack->get_children_in_range(150.0f, 160.0f);
+    CHECK_EQUAL(range.count(), Uint(0));
+
+    backend.destroy();
+    row.destroy();
+
+    // Direction::max: The first child is at the max edge.
+    row = Card_Row {};
+    row.create(10, V2f { 10, 10 }, Direction::max);
+
+    create_backend(&backend);
+    row.gui.render_frame(V2f { 200, 60 }, &backend);
+
+    range = row.stack->get_children_in_range(85.0f, 100.0f);
+    CHECK_EQUAL(range._begin, Uint(0));
+    CHECK_EQUAL(range._end,   Uint(2));
+
+    backend.destroy();
+    row.destroy();
+}
+
+// Only the visible children's bounds are tested.
+static void test_long_row() {
+    auto row = Card_Row {};
+    row.create(10000, V2f { 10, 10 }, Direction::min);
+
+    auto backend = CPU_Backend {};
+    create_backend(&backend);
+    row.gui.render_frame(V2f { 200, 60 }, &backend);
+
+    // The default shadow (offset 2, blur 3) extends 5px below the cards.
+    CHECK(row.stack->child_paint_overflow == 5.0f);
+
+    row.get_paint_bounds_count();
+    row.gui.damage_all();
+    row.gui.render_frame(V2f { 200, 60 }, &backend);
+
+    // [0, 200) grown by the overflow -> children 0 to 20.
+    CHECK_EQUAL(row.get_paint_bounds_count(), Uint(21));
+    CHECK_EQUAL(row.gui.replayed_widget_count, Uint(22));
+    CHECK_EQUAL(row.gui.culled_widget_count,   Uint(10000 - 21));
+
+    backend.destroy();
+    row.destroy();
+}
+
+// Children whose shadows reach into the damage are repainted, even if their
+// rects are outside it.
+static void test_overflow() {
+    auto row = Card_Row {};
+    row.create(5, V2f { 20, 20 }, Direction::min);
+
+    for(auto card : row.cards) {
+        card->shadow_color       = V4f { 0.0f, 0.0f, 0.0f, 0.5f };
+        card->shadow_offset      = V2f { 8.0f, 0.0f };
+        card->shadow_blur_radius = 2.0f;
+    }
+
+    auto backend = CPU_Backend {};
+    create_backend(&backend);
+    row.gui.render_frame(V2f { 200, 60 }, &backend);
+
+    CHECK(row.stack->child_paint_overflow == 10.0f);
+
+    // Damage: exactly card 2's rect, [40, 60). Card 1's shadow covers
+    // [26, 50).
+    auto card = row.cards[2];
+    card->shadow_color = V4f { 0.0f, 0.0f, 0.0f, 0.0f };
+    card->fill_color   = V4f { 0.9f, 0.1f, 0.1f, 0.5f };
+    card->mark_for_paint();
+
+    auto& damage = row.gui.render_frame(V2f { 200, 60 }, &backend);
+    CHECK_EQUAL(damage.size(), Uint(1));
+
+    auto reference = CPU_Backend {};
+    create_backend(&reference);
+    row.gui.damage_all();
+    row.gui.render_frame(V2f { 200, 60 }, &reference);
+
+    CHECK(backend.pixels == reference.pixels);
+
+    reference.destroy();
+    backend.destroy();
+    row.destroy();
+}
+
+// Children that move repaint their old and new shadows, even outside their
+// parent's bounds. (The stack is 20px high, the shadows reach 25px.)
+static void test_moved_children() {
+    auto row = Card_Row {};
+    row.create(5, V2f { 20, 20 }, Direction::min);
+
+    auto backend = CPU_Backend {};
+    create_backend(&backend);
+    row.gui.render_frame(V2f { 200, 60 }, &backend);
+
+    // Remove the first card. The others move left.
+    auto def = row.gui.create_def<Stack_Def>();
+    def->axis = Axis::x;
+    for(Uint i = 1; i < row.cards.size(); i += 1) {
+        def->children.push_back(row.gui.create_def<Widget_Def>(row.cards[i]));
+    }
+    row.gui.set_root(def);
+    row.cards.erase(row.cards.begin());
+
+    row.gui.render_frame(V2f { 200, 60 }, &backend);
+
+    auto reference = CPU_Backend {};
+    create_backend(&reference);
+    row.gui.damage_all();
+    row.gui.render_frame(V2f { 200, 60 }, &reference);
+
+    CHECK(backend.pixels == reference.pixels);
+
+    reference.destroy();
+    backend.destroy();
+    row.destroy();
+}
+
+// Damage that only touches the children's shadows, below the stack: The
+// stack isn't culled.
+static void test_damage_in_overflow() {
+    auto row = Card_Row {};
+    row.create(5, V2f { 20, 20 }, Direction::min);
+
+    auto backend = CPU_Backend {};
+    create_backend(&backend);
+    row.gui.render_frame(V2f { 200, 60 }, &backend);
+
+    auto reference = backend.pixels;
+
+    row.gui.add_damage(Paint_Bounds { V2f { 0, 21 }, V2f { 200, 24 } });
+    auto& damage = row.gui.render_frame(V2f { 200, 60 }, &backend);
+    CHECK_EQUAL(damage.size(), Uint(1));
+
+    CHECK(backend.pixels == reference);
+    CHECK(row.stack->replay_bounds.max.y >= 25.0f);
+
+    backend.destroy();
+    row.destroy();
+}
+
+
+int main() {
+    test_children_in_range();
+    test_long_row();
+    test_overflow();
+    test_moved_children();
+    test_damage_in_overflow();
+    return get_test_exit_code();
+}
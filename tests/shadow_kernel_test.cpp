@@ -0,0 +1,150 @@
+#include <cmath>
+
+#include <cpp-gui/shadow_kernel.hpp>
+
+#include "test.hpp"
+
+
+// Shadow_Kernel against a reference Gaussian blur.
+//  - Reference: The exact rounded rect, convolved with a Gaussian (standard
+//    deviation blur_radius/3, cut off at blur_radius and normalized). Exact
+//    erf along x, numeric integration along y, in doubles.
+//  - Bound: The 8 bit coverage is within 1/255 of the reference. (The
+//    kernel's own error, from the A&S 7.1.27 erf approximation and the
+//    corner slices, plus rounding.)
+//  - Straight rows (only erf) and corner rows (slices) are measured
+//    separately, so each path has to meet the bound.
+
+
+static const Float64 max_error = 1.0; // in 1/255.
+
+static const Float64 pi = 3.14159265358979323846;
+
+
+struct Shadow_Case {
+    V2f     half_size;
+    Float32 radius;
+    Float32 blur_radius;
+};
+
+static Float64 get_reference_coverage(V2f center, const Shadow_Case& shadow, Float64 px, Float64 py) {
+    auto blur  = Float64(shadow.blur_radius);
+    auto sigma = blur/3.0;
+    auto k     = 1.0/(sqrt(2.0)*sigma);
+    auto norm  = erf(3.0/sqrt(2.0));
+
+    auto half_x = Float64(shadow.half_size.x);
+    auto half_y = Float64(shadow.half_size.y);
+    auto r      = fmin(fmax(Float64(shadow.radius), 0.0), fmin(half_x, half_y));
+
+    // Midpoint rule along y, over the part of the window inside the rect.
+    auto dy = py - center.y;
+    auto v0 = fmax(-blur, -half_y - dy);
+    auto v1 = fmin( blur,  half_y - dy);
+    if(v1 <= v0) {
+        return 0.0;
+    }
+
+    auto const sample_count = 400; // 10x more changes the errors by < 0.01/255.
+    auto step = (v1 - v0)/sample_count;
+
+    auto dx  = px - center.x;
+    auto sum = 0.0;
+    for(auto i = 0; i < sample_count; i += 1) {
+        auto v = v0 + (i + 0.5)*step;
+        auto y = dy + v;
+
+        // Half width of the rect at y.
+        auto corner_y = fabs(y) - (half_y - r);
+        auto width = half_x - r + (corner_y > 0.0 ? sqrt(fmax(r*r - corner_y*corner_y, 0.0)) : r);
+
+        auto weight = exp(-v*v/(2.0*sigma*sigma))/(sqrt(2.0*pi)*sigma)*step/norm;
+
+        auto x0 = fmin(fmax(-width - dx, -blur), blur);
+        auto x1 = fmin(fmax( width - dx, -blur), blur);
+        sum += weight*0.5*(erf(x1*k) - erf(x0*k))/norm;
+    }
+
+    return sum;
+}
+
+
+static void test_accuracy(const Shadow_Case& shadow) {
+    // Not on the pixel grid.
+    auto center = V2f { 200.3f, 150.6f };
+
+    auto kernel = Shadow_Kernel {};
+    kernel.create(center, shadow.half_size, shadow.radius, shadow.blur_radius);
+
+    auto x0 = Sint32(center.x - shadow.half_size.x - shadow.blur_radius) - 1;
+    auto x1 = Sint32(center.x + shadow.half_size.x + shadow.blur_radius) + 2;
+    auto y0 = Sint32(center.y - shadow.half_size.y - shadow.blur_radius) - 1;
+    auto y1 = Sint32(center.y + shadow.half_size.y + shadow.blur_radius) + 2;
+
+    auto effective_radius = min(shadow.radius, min(shadow.half_size.x, shadow.half_size.y));
+    auto straight = Float64(shadow.half_size.y - effective_radius);
+
+    auto max_straight_error = 0.0;
+    auto max_corner_error   = 0.0;
+    auto max_span_mismatch  = 0.0;
+
+    auto coverage = List<Uint8>(Uint(x1 - x0));
+    for(auto y = y0; y < y1; y += 1) {
+        auto row = kernel.get_row(Float32(y) + 0.5f);
+        kernel.get_span_coverage(row, x0, Uint(x1 - x0), coverage.data());
+
+        // Rows whose blur window reaches a corner band use the slices.
+        auto dy = fabs(Float64(y) + 0.5 - center.y);
+        auto is_corner_row = effective_radius > 0.0f && dy + shadow.blur_radius > straight;
+
+        for(auto x = x0; x < x1; x += 1) {
+            auto value = Float64(coverage[Uint(x - x0)]);
+
+            auto reference = 255.0*get_reference_coverage(center, shadow, x + 0.5, y + 0.5);
+            auto error = fabs(value - reference);
+            if(is_corner_row) {
+                max_corner_error = fmax(max_corner_error, error);
+            }
+            else {
+                max_straight_error = fmax(max_straight_error, error);
+            }
+
+            // The scalar path agrees with the spans (up to rounding).
+            auto point = kernel.get_coverage(V2f { Float32(x) + 0.5f, Float32(y) + 0.5f });
+            max_span_mismatch = fmax(max_span_mismatch, fabs(255.0*point - value));
+        }
+    }
+
+    printf(
+        "half size (%g, %g), radius %g, blur %g: straight %.3f/255, corner %.3f/255.\n",
+        shadow.half_size.x, shadow.half_size.y, shadow.radius, shadow.blur_radius,
+        max_straight_error, max_corner_error
+    );
+
+    CHECK(max_straight_error <= max_error);
+    CHECK(max_corner_error   <= max_error);
+    CHECK(max_span_mismatch  <= 0.5 + 1e-3);
+}
+
+
+int main() {
+    Shadow_Case const cases[] = {
+        // Sharp corners: Only erf.
+        { V2f {  50, 30 },  0, 10 },
+        // Typical button shadows.
+        { V2f {  20, 10 },  6,  4 },
+        { V2f { 100, 60 }, 20,  3 },
+        // Circle, pill.
+        { V2f {  15, 15 }, 15,  8 },
+        { V2f {  40, 12 }, 12, 24 },
+        // Small rect, blur larger than the rect.
+        { V2f {   8,  3 },  3,  2 },
+        { V2f {  30, 20 }, 10, 60 },
+    };
+
+    for(auto& shadow : cases) {
+        test_accuracy(shadow);
+    }
+
+    return get_test_exit_code();
+}
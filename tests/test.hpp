@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdio>
+
+
+// Minimal test harness.
+//  - Each test file is an executable, registered with CTest (see
+//    CMakeLists.txt).
+//  - Failed checks are reported and counted. main returns
+//    get_test_exit_code().
+
+static int test_failure_count = 0;
+
+#define CHECK(condition) \
+    do { \
+        if(!(condition)) { \
+            test_failure_count += 1; \
+            printf("%s:%d: CHECK(%s) failed.\n", __FILE__, __LINE__, #condition); \
+        } \
+    } while(0)
+
+#define CHECK_EQUAL(a, b) \
+    do { \
+        auto _a = (a); \
+        auto _b = (b); \
+        if(!(_a == _b)) { \
+            test_failure_count += 1; \
+            printf( \
+                "%s:%d: CHECK_EQUAL(%s, %s) failed: 0x%llx != 0x%llx.\n", \
+                __FILE__, __LINE__, #a, #b, \
+                (unsigned long long)_a, (unsigned long long)_b \
+            ); \
+        } \
+    } while(0)
+
+inline int get_test_exit_code() {
+    if(test_failure_count != 0) {
+        printf("%d check(s) failed.\n", test_failure_count);
+        return 1;
+    }
+
+    printf("ok.\n");
+    return 0;
+}
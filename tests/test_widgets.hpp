@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cpp-gui/core/gui.hpp>
+#include <cpp-gui/widgets/rounded.hpp>
+#include <cpp-gui/widgets/solid.hpp>
+#include <cpp-gui/widgets/shadow.hpp>
+
+
+// Widgets shared by the tests.
+
+
+// A rounded, filled rect with a shadow. Like the sandbox's buttons.
+//  - Has a fixed size.
+//  - Counts get_paint_bounds calls.
+struct Card_Widget : virtual Rounded_Widget, Solid_Widget, Shadow_Widget {
+    V2f  card_size;
+    Uint paint_bounds_count = 0;
+
+    virtual Bool on_try_match(Def* def) override {
+        UNUSED(def);
+        return false;
+    }
+
+    virtual void on_layout(Box_Constraints constraints) override {
+        UNUSED(constraints);
+        this->size = this->card_size;
+    }
+
+    virtual void on_paint(Display_List* list) override {
+        Shadow_Widget::on_paint(list);
+        Solid_Widget::on_paint(list);
+    }
+
+    virtual Paint_Bounds get_paint_bounds() override {
+        this->paint_bounds_count += 1;
+        return Shadow_Widget::get_paint_bounds();
+    }
+};